@@ -11,6 +11,8 @@
 #include "ChiExtractionTaggingCriterion.hpp"
 #include "ChiPunctureExtractionTaggingCriterion.hpp"
 #include "ComputePack.hpp"
+#include "DiagnosticsSnapshot.hpp"
+#include "MultiLevelTask.hpp"
 #include "NanCheck.hpp"
 #include "NewConstraints.hpp"
 #include "PositiveChiAndAlpha.hpp"
@@ -22,6 +24,8 @@
 #include "TwoPuncturesInitialData.hpp"
 #include "Weyl4.hpp"
 #include "WeylExtraction.hpp"
+#include <future>
+#include <memory>
 
 // Things to do during the advance step after RK4 steps
 void BinaryBHLevel::specificAdvance()
@@ -43,13 +47,23 @@ void BinaryBHLevel::initialData()
     CH_TIME("BinaryBHLevel::initialData");
     if (m_verbosity)
         pout() << "BinaryBHLevel::initialData " << m_level << endl;
+
+    // take the data from a checkpoint at another resolution if warm starting
+    if (warmStartData())
+        return;
 #ifdef USE_TWOPUNCTURES
-    TwoPuncturesInitialData two_punctures_initial_data(
-        m_dx, m_p.center, m_tp_amr.m_two_punctures);
-    // Can't use simd with this initial data
-    BoxLoops::loop(two_punctures_initial_data, m_state_new, m_state_new,
-                   INCLUDE_GHOST_CELLS, disable_simd());
-#else
+    // a dry run only needs data to tag the grids (and time the RHS) so the
+    // approximate data below is used without solving for TwoPunctures
+    if (!m_gr_amr.is_dry_run())
+    {
+        TwoPuncturesInitialData two_punctures_initial_data(
+            m_dx, m_p.center, m_tp_amr.m_two_punctures);
+        // Can't use simd with this initial data
+        BoxLoops::loop(two_punctures_initial_data, m_state_new, m_state_new,
+                       INCLUDE_GHOST_CELLS, disable_simd());
+        return;
+    }
+#endif
     // Set up the compute class for the BinaryBH initial data
     BinaryBH binary(m_p.bh1_params, m_p.bh2_params, m_dx);
 
@@ -57,7 +71,6 @@ void BinaryBHLevel::initialData()
     // then calculate initial data
     BoxLoops::loop(make_compute_pack(SetValue(0.), binary), m_state_new,
                    m_state_new, INCLUDE_GHOST_CELLS);
-#endif
 }
 
 // Calculate RHS during RK4 substeps
@@ -68,19 +81,22 @@ void BinaryBHLevel::specificEvalRHS(GRLevelData &a_soln, GRLevelData &a_rhs,
     BoxLoops::loop(make_compute_pack(TraceARemoval(), PositiveChiAndAlpha()),
                    a_soln, a_soln, INCLUDE_GHOST_CELLS);
 
-    // Calculate CCZ4 right hand side
+    // Calculate CCZ4 right hand side (including any ghosts needed in deep
+    // halo mode)
+    const IntVect rhs_ghosts = get_rhs_ghosts_to_fill();
     if (m_p.max_spatial_derivative_order == 4)
     {
         BoxLoops::loop(CCZ4RHS<MovingPunctureGauge, FourthOrderDerivatives>(
                            m_p.ccz4_params, m_dx, m_p.sigma, m_p.formulation),
-                       a_soln, a_rhs, EXCLUDE_GHOST_CELLS);
+                       a_soln, a_rhs, rhs_ghosts);
     }
     else if (m_p.max_spatial_derivative_order == 6)
     {
         BoxLoops::loop(CCZ4RHS<MovingPunctureGauge, SixthOrderDerivatives>(
                            m_p.ccz4_params, m_dx, m_p.sigma, m_p.formulation),
-                       a_soln, a_rhs, EXCLUDE_GHOST_CELLS);
+                       a_soln, a_rhs, rhs_ghosts);
     }
+    mark_rhs_halo_filled();
 }
 
 // enforce trace removal during RK4 substeps
@@ -95,6 +111,36 @@ void BinaryBHLevel::preTagCells()
 {
     // We only use chi in the tagging criterion so only fill the ghosts for chi
     fillAllGhosts(VariableType::evolution, Interval(c_chi, c_chi));
+
+    // the tags on this level make the finest level so remember where the
+    // punctures should stay until the next regrid to check they do
+    if (m_p.track_punctures && m_p.predictive_puncture_tagging &&
+        m_level == m_p.max_level - 1)
+    {
+        PunctureTracker &puncture_tracker = m_bh_amr.m_puncture_tracker;
+        const double time_between_regrids = get_time_between_regrids();
+        std::vector<double> puncture_radii = get_puncture_masses();
+        for (double &radius : puncture_radii)
+        {
+            radius =
+                ChiPunctureExtractionTaggingCriterion::tagged_puncture_radius(
+                    radius, m_level, m_p.max_level);
+        }
+        puncture_tracker.set_predicted_regions(
+            puncture_tracker.get_predicted_puncture_coords(
+                time_between_regrids),
+            puncture_radii, m_time + time_between_regrids);
+    }
+}
+
+std::vector<double> BinaryBHLevel::get_puncture_masses() const
+{
+#ifdef USE_TWOPUNCTURES
+    // use calculated bare masses from TwoPunctures
+    return {m_tp_amr.m_two_punctures.mm, m_tp_amr.m_two_punctures.mp};
+#else
+    return {m_p.bh1_params.mass, m_p.bh2_params.mass};
+#endif /* USE_TWOPUNCTURES */
 }
 
 // specify the cells to tag
@@ -103,20 +149,28 @@ void BinaryBHLevel::computeTaggingCriterion(FArrayBox &tagging_criterion,
 {
     if (m_p.track_punctures)
     {
-        std::vector<double> puncture_masses;
-#ifdef USE_TWOPUNCTURES
-        // use calculated bare masses from TwoPunctures
-        puncture_masses = {m_tp_amr.m_two_punctures.mm,
-                           m_tp_amr.m_two_punctures.mp};
-#else
-        puncture_masses = {m_p.bh1_params.mass, m_p.bh2_params.mass};
-#endif /* USE_TWOPUNCTURES */
-        auto puncture_coords =
-            m_bh_amr.m_puncture_tracker.get_puncture_coords();
+        const std::vector<double> puncture_masses = get_puncture_masses();
+        const PunctureTracker &puncture_tracker = m_bh_amr.m_puncture_tracker;
+        auto puncture_coords = puncture_tracker.get_puncture_coords();
+
+        // how far the punctures are predicted to move before the grids made
+        // from these tags are remade
+        std::vector<std::array<double, CH_SPACEDIM>> puncture_displacements;
+        if (m_p.predictive_puncture_tagging)
+        {
+            puncture_displacements = puncture_tracker.get_puncture_velocities();
+            const double time_between_regrids = get_time_between_regrids();
+            for (auto &displacement : puncture_displacements)
+            {
+                FOR1(i) { displacement[i] *= time_between_regrids; }
+            }
+        }
+
         BoxLoops::loop(ChiPunctureExtractionTaggingCriterion(
                            m_dx, m_level, m_p.max_level, m_p.extraction_params,
                            puncture_coords, m_p.activate_extraction,
-                           m_p.track_punctures, puncture_masses),
+                           m_p.track_punctures, puncture_masses,
+                           puncture_displacements),
                        current_state, tagging_criterion);
     }
     else
@@ -128,6 +182,133 @@ void BinaryBHLevel::computeTaggingCriterion(FArrayBox &tagging_criterion,
     }
 }
 
+void BinaryBHLevel::computeWeyl4()
+{
+    // Populate the Weyl Scalar values on the grid
+    fillAllGhosts();
+    BoxLoops::loop(Weyl4(m_p.extraction_params.center, m_dx), m_state_new,
+                   m_state_diagnostics, EXCLUDE_GHOST_CELLS);
+}
+
+void BinaryBHLevel::seedWeylDenseOutput()
+{
+    CH_TIME("BinaryBHLevel::seedWeylDenseOutput");
+
+    const double dense_output_dt = m_p.extraction_params.dense_output_dt;
+    const int min_level = m_p.extraction_params.min_extraction_level();
+    if (m_p.activate_extraction != 1 || dense_output_dt <= 0. ||
+        m_level < min_level)
+        return;
+
+    computeWeyl4();
+    if (m_level == min_level)
+    {
+        // the output up to this time has already been written so only the
+        // extracted data is needed (not its output)
+        m_gr_amr.m_interpolator->refresh_on_demand();
+        WeylExtraction extraction(m_p.extraction_params, m_dt, m_time, false,
+                                  m_restart_time);
+        extraction.extract(m_gr_amr.m_interpolator);
+
+        SurfaceDenseOutput &dense_output = m_bh_amr.m_weyl_dense_output;
+        if (dense_output.get_output_dt() != dense_output_dt)
+            dense_output.set_output_dt(dense_output_dt);
+        dense_output.seed(m_time, extraction.get_interp_data());
+    }
+}
+
+void BinaryBHLevel::computeConstraintsOnAllLevels()
+{
+    CH_TIME("BinaryBHLevel::computeConstraintsOnAllLevels");
+
+    // each level's ghosts are interpolated from the coarser level
+    m_gr_amr.fill_multilevel_ghosts(VariableType::evolution);
+
+    // the boxes are independent so share the boxes of all the levels between
+    // the threads (rather than each level's in turn, which leaves most of
+    // them idle on the small fine levels)
+    MultiLevelTaskPtr<> constraints_task(
+        [](GRAMRLevel *a_level, const DataIndex &a_index) {
+            BinaryBHLevel &level = *static_cast<BinaryBHLevel *>(a_level);
+            BoxLoops::loop(
+                Constraints(level.m_dx, c_Ham, Interval(c_Mom1, c_Mom3)),
+                level.m_state_new[a_index], level.m_state_diagnostics[a_index],
+                level.m_grids[a_index]);
+        });
+    constraints_task.execute(m_gr_amr);
+}
+
+void BinaryBHLevel::snapshotForConstraints()
+{
+    if (m_bh_amr.m_constraints_snapshot == nullptr)
+    {
+        m_bh_amr.m_constraints_snapshot =
+            std::make_shared<DiagnosticsSnapshot>();
+    }
+    m_bh_amr.m_constraints_snapshot->add_level(
+        m_level, m_state_new, m_dx, refRatio(), NUM_DIAGNOSTIC_VARS);
+}
+
+void BinaryBHLevel::computeConstraintNormsInBackground(bool a_first_step)
+{
+    CH_TIME("BinaryBHLevel::computeConstraintNormsInBackground");
+
+    std::shared_ptr<DiagnosticsSnapshot> snapshot =
+        std::move(m_bh_amr.m_constraints_snapshot);
+    if (snapshot == nullptr ||
+        !snapshot->has_levels(m_gr_amr.get_finest_level()))
+    {
+        MayDay::Error("BinaryBHLevel::computeConstraintNormsInBackground: "
+                      "not every level has been copied");
+    }
+
+    // the norms of the previous coarse step, whose constraints have been
+    // computed while this one was evolved
+    m_gr_amr.run_deferred_diagnostics();
+
+    // the boxes are only accessed through raw pointers in the background
+    // (with their own OpenMP threads) and the snapshot is freed here
+    auto computed = std::make_shared<std::promise<void>>();
+    std::shared_future<void> constraints_done = computed->get_future();
+    m_gr_amr.m_diagnostics_queue.push([boxes = &snapshot->boxes(), computed]() {
+        for (const DiagnosticsSnapshot::box_t &box : *boxes)
+        {
+            BoxLoops::loop(Constraints(box.dx, c_Ham, Interval(c_Mom1, c_Mom3)),
+                           *box.state, *box.diagnostics, box.valid_box);
+        }
+        computed->set_value();
+    });
+
+    // the reductions need MPI so are done on the main thread
+    m_gr_amr.defer_diagnostics(
+        [snapshot, constraints_done, queue = &m_gr_amr.m_diagnostics_queue,
+         filename = m_p.data_path + "constraint_norms", dt = m_dt,
+         time = m_time, restart_time = m_restart_time, a_first_step]() {
+            constraints_done.wait();
+            double L2_Ham = snapshot->norm(Interval(c_Ham, c_Ham));
+            double L2_Mom = snapshot->norm(Interval(c_Mom1, c_Mom3));
+            queue->push([filename, dt, time, restart_time, a_first_step,
+                         L2_Ham, L2_Mom]() {
+                writeConstraintNorms(filename, dt, time, restart_time,
+                                     a_first_step, L2_Ham, L2_Mom);
+            });
+        });
+}
+
+void BinaryBHLevel::writeConstraintNorms(const std::string &a_filename,
+                                         double a_dt, double a_time,
+                                         double a_restart_time,
+                                         bool a_first_step, double a_L2_Ham,
+                                         double a_L2_Mom)
+{
+    SmallDataIO constraints_file(a_filename, a_dt, a_time, a_restart_time,
+                                 SmallDataIO::APPEND, a_first_step);
+    constraints_file.remove_duplicate_time_data();
+    if (a_first_step)
+        constraints_file.write_header_line({"L^2_Ham", "L^2_Mom"});
+    constraints_file.write_time_data_line({a_L2_Ham, a_L2_Mom});
+}
+
 void BinaryBHLevel::specificPostTimeStep()
 {
     CH_TIME("BinaryBHLevel::specificPostTimeStep");
@@ -143,50 +324,112 @@ void BinaryBHLevel::specificPostTimeStep()
         bool calculate_weyl = at_level_timestep_multiple(min_level);
         if (calculate_weyl)
         {
-            // Populate the Weyl Scalar values on the grid
-            fillAllGhosts();
-            BoxLoops::loop(Weyl4(m_p.extraction_params.center, m_dx),
-                           m_state_new, m_state_diagnostics,
-                           EXCLUDE_GHOST_CELLS);
+            computeWeyl4();
 
             // Do the extraction on the min extraction level
             if (m_level == min_level)
             {
                 CH_TIME("WeylExtraction");
                 // Now refresh the interpolator and do the interpolation
-                // fill ghosts manually to minimise communication
-                bool fill_ghosts = false;
-                m_gr_amr.m_interpolator->refresh(fill_ghosts);
-                m_gr_amr.fill_multilevel_ghosts(
-                    VariableType::diagnostic, Interval(c_Weyl4_Re, c_Weyl4_Im),
-                    min_level);
-                WeylExtraction my_extraction(m_p.extraction_params, m_dt,
-                                             m_time, first_step,
-                                             m_restart_time);
-                my_extraction.execute_query(m_gr_amr.m_interpolator);
+                // (which only fills the Weyl4 ghosts on the levels the
+                // extraction spheres are interpolated from)
+                m_gr_amr.m_interpolator->refresh_on_demand();
+                // the interpolation is collective but the integration and
+                // output can be done in the background
+                auto my_extraction = std::make_shared<WeylExtraction>(
+                    m_p.extraction_params, m_dt, m_time, first_step,
+                    m_restart_time);
+                my_extraction->extract(m_gr_amr.m_interpolator);
+
+                const double dense_output_dt =
+                    m_p.extraction_params.dense_output_dt;
+                if (dense_output_dt > 0.)
+                {
+                    // output at a uniform cadence by interpolating in time
+                    // between the extractions (no further interpolator calls)
+                    SurfaceDenseOutput &dense_output =
+                        m_bh_amr.m_weyl_dense_output;
+                    if (dense_output.get_output_dt() != dense_output_dt)
+                        dense_output.set_output_dt(dense_output_dt);
+                    const std::vector<double> output_times =
+                        dense_output.add_sample(
+                            m_time, my_extraction->get_interp_data());
+                    for (double output_time : output_times)
+                    {
+                        auto dense_extraction =
+                            std::make_shared<WeylExtraction>(
+                                m_p.extraction_params, dense_output_dt,
+                                output_time, output_time == 0.,
+                                m_restart_time);
+                        dense_extraction->set_interp_data(
+                            dense_output.interpolate(output_time));
+                        m_gr_amr.m_diagnostics_queue.push(
+                            [dense_extraction]() {
+                                dense_extraction->process_extraction();
+                            });
+                    }
+                }
+                else
+                {
+                    m_gr_amr.m_diagnostics_queue.push([my_extraction]() {
+                        my_extraction->process_extraction();
+                    });
+                }
             }
         }
     }
 
-    if (m_p.calculate_constraint_norms)
+    // By default each level computes the constraints after each of its
+    // substeps. Optionally, they are only computed at the end of each coarse
+    // step (when the norms are taken) with the boxes of all levels shared
+    // between the threads. The coarse-fine ghosts are then interpolated after
+    // the averaging so the norms differ slightly. With async_diagnostics,
+    // the constraints the norms are taken of are computed in the background
+    // on a copy of the levels (with the same ghosts) instead
+    const bool background_constraints =
+        m_p.calculate_constraint_norms &&
+        m_gr_amr.m_diagnostics_queue.is_asynchronous();
+    if (m_p.calculate_constraint_norms &&
+        !m_p.constraints_on_all_levels_at_once)
     {
         fillAllGhosts();
-        BoxLoops::loop(Constraints(m_dx, c_Ham, Interval(c_Mom1, c_Mom3)),
-                       m_state_new, m_state_diagnostics, EXCLUDE_GHOST_CELLS);
-        if (m_level == 0)
+        if (background_constraints && at_level_timestep_multiple(0))
+            snapshotForConstraints();
+        else
         {
+            BoxLoops::loop(Constraints(m_dx, c_Ham, Interval(c_Mom1, c_Mom3)),
+                           m_state_new, m_state_diagnostics,
+                           EXCLUDE_GHOST_CELLS);
+        }
+    }
+    if (m_p.calculate_constraint_norms && m_level == 0)
+    {
+        if (background_constraints)
+        {
+            if (m_p.constraints_on_all_levels_at_once)
+            {
+                m_gr_amr.fill_multilevel_ghosts(VariableType::evolution);
+                for (GRAMRLevel *level : m_gr_amr.get_gramrlevels())
+                    static_cast<BinaryBHLevel *>(level)
+                        ->snapshotForConstraints();
+            }
+            computeConstraintNormsInBackground(first_step);
+        }
+        else
+        {
+            if (m_p.constraints_on_all_levels_at_once)
+                computeConstraintsOnAllLevels();
             AMRReductions<VariableType::diagnostic> amr_reductions(m_gr_amr);
             double L2_Ham = amr_reductions.norm(c_Ham);
             double L2_Mom = amr_reductions.norm(Interval(c_Mom1, c_Mom3));
-            SmallDataIO constraints_file(m_p.data_path + "constraint_norms",
-                                         m_dt, m_time, m_restart_time,
-                                         SmallDataIO::APPEND, first_step);
-            constraints_file.remove_duplicate_time_data();
-            if (first_step)
-            {
-                constraints_file.write_header_line({"L^2_Ham", "L^2_Mom"});
-            }
-            constraints_file.write_time_data_line({L2_Ham, L2_Mom});
+            // the writing can be done in the background
+            m_gr_amr.m_diagnostics_queue.push(
+                [filename = m_p.data_path + "constraint_norms", dt = m_dt,
+                 time = m_time, restart_time = m_restart_time, first_step,
+                 L2_Ham, L2_Mom]() {
+                    writeConstraintNorms(filename, dt, time, restart_time,
+                                         first_step, L2_Ham, L2_Mom);
+                });
         }
     }
 
@@ -13,6 +13,13 @@
 
 class BinaryBHLevel : public GRAMRLevel
 {
+  public:
+    /// Extracts the Weyl scalars at the current (restart) time to start the
+    /// dense output of the extraction from (if extraction_dense_output_dt is
+    /// set). It must be called on the finer levels first.
+    void seedWeylDenseOutput();
+
+  private:
     friend class DefaultLevelFactory<BinaryBHLevel>;
     // Inherit the contructors from GRAMRLevel
     using GRAMRLevel::GRAMRLevel;
@@ -49,6 +56,32 @@ class BinaryBHLevel : public GRAMRLevel
     // to do post each time step on every level
     virtual void specificPostTimeStep() override;
 
+    /// Computes the Weyl scalars on this level (with its ghosts filled)
+    void computeWeyl4();
+
+    /// Computes the constraints on every level (called on level 0 at the
+    /// end of a coarse step, when all the levels are at the same time)
+    void computeConstraintsOnAllLevels();
+
+    /// Copies this level (with its ghosts filled) into the snapshot the
+    /// constraints are computed on in the background
+    void snapshotForConstraints();
+
+    /// Computes the constraints on the snapshot of all the levels in the
+    /// background and defers their norms and output (called on level 0 at
+    /// the end of a coarse step)
+    void computeConstraintNormsInBackground(bool a_first_step);
+
+    /// Appends the constraint norms at a_time to a_filename
+    static void writeConstraintNorms(const std::string &a_filename,
+                                     double a_dt, double a_time,
+                                     double a_restart_time, bool a_first_step,
+                                     double a_L2_Ham, double a_L2_Mom);
+
+    /// The masses used to set the size of the regions tagged around the
+    /// punctures
+    std::vector<double> get_puncture_masses() const;
+
 #ifdef CH_USE_HDF5
     /// Any actions that should happen just before plot files output
     virtual void prePlotLevel() override;
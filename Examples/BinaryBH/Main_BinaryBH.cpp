@@ -14,6 +14,8 @@
 // Our includes
 #include "DefaultLevelFactory.hpp"
 #include "GRParmParse.hpp"
+#include "InSituSliceRenderer.hpp"
+#include "InSituStatistics.hpp"
 #include "MultiLevelTask.hpp"
 #include "SetupFunctions.hpp"
 #include "SimulationParameters.hpp"
@@ -40,8 +42,10 @@ int runGRChombo(int argc, char *argv[])
 #ifdef USE_TWOPUNCTURES
     TPAMR bh_amr;
     bh_amr.set_two_punctures_parameters(sim_params.tp_params);
-    // Run TwoPunctures solver
-    bh_amr.m_two_punctures.Run();
+    // Run TwoPunctures solver (not needed if the initial data is taken from
+    // the warm_start_file or only the grids are built for a dry run)
+    if (!sim_params.warm_start && !sim_params.dry_run)
+        bh_amr.m_two_punctures.Run();
 #else
     BHAMR bh_amr;
 #endif
@@ -64,6 +68,13 @@ int runGRChombo(int argc, char *argv[])
     DefaultLevelFactory<BinaryBHLevel> binary_bh_level_fact(bh_amr, sim_params);
     setupAMRObject(bh_amr, binary_bh_level_fact);
 
+    // estimate the cost of the run from the initial hierarchy and stop
+    if (sim_params.dry_run)
+    {
+        bh_amr.dry_run(sim_params.dry_run_num_ranks);
+        return 0;
+    }
+
     // call this after amr object setup so grids known
     // and need it to stay in scope throughout run
     AMRInterpolator<Lagrange<4>> interpolator(
@@ -76,6 +87,40 @@ int runGRChombo(int argc, char *argv[])
     if (sim_params.track_punctures)
         bh_amr.m_puncture_tracker.restart_punctures();
 
+    // the dense output of the Weyl extraction restarts from the data at the
+    // restart time so that the output times before the next extraction are
+    // not missed
+    if (sim_params.restart_from_checkpoint)
+    {
+        MultiLevelTaskPtr<> seed_task([](GRAMRLevel *level) {
+            dynamic_cast<BinaryBHLevel *>(level)->seedWeylDenseOutput();
+        });
+        seed_task.execute(bh_amr);
+    }
+
+    // small in-situ products of one variable (e.g. instead of frequent plot
+    // files)
+    if (sim_params.insitu_interval > 0 || sim_params.insitu_at_plot)
+    {
+        const double restart_time = bh_amr.get_gramrlevels()[0]->time();
+        const std::string prefix =
+            sim_params.data_path + "insitu_" + sim_params.insitu_var_name;
+        bh_amr.add_in_situ_analysis(
+            InSituStatistics(sim_params.insitu_var, sim_params.insitu_var_type,
+                             prefix, sim_params.insitu_histogram_bins,
+                             sim_params.insitu_min, sim_params.insitu_max,
+                             restart_time),
+            sim_params.insitu_interval, sim_params.insitu_at_plot);
+        bh_amr.add_in_situ_analysis(
+            InSituSliceRenderer(
+                sim_params.insitu_var, sim_params.insitu_var_type,
+                prefix + "_slice_", sim_params.insitu_slice_normal_dir,
+                sim_params.insitu_slice_position,
+                sim_params.insitu_slice_pixels, sim_params.insitu_min,
+                sim_params.insitu_max),
+            sim_params.insitu_interval, sim_params.insitu_at_plot);
+    }
+
     using Clock = std::chrono::steady_clock;
     using Minutes = std::chrono::duration<double, std::ratio<60, 1>>;
 
@@ -37,8 +37,44 @@ class SimulationParameters : public SimulationParametersBase
         // Do we want puncture tracking and constraint norm calculation?
         pp.load("track_punctures", track_punctures, false);
         pp.load("puncture_tracking_level", puncture_tracking_level, max_level);
+        // tag the region each puncture is predicted to sweep out before the
+        // next regrid rather than a sphere around its current position
+        pp.load("predictive_puncture_tagging", predictive_puncture_tagging,
+                false);
         pp.load("calculate_constraint_norms", calculate_constraint_norms,
                 false);
+        // compute the constraints on all levels at once at the end of each
+        // coarse step rather than on each level after its substeps (the
+        // coarse-fine ghosts are interpolated after averaging down so the
+        // norms change slightly)
+        pp.load("constraints_on_all_levels_at_once",
+                constraints_on_all_levels_at_once, false);
+
+        // In-situ statistics and slice images of one variable
+        pp.load("insitu_interval", insitu_interval, 0);
+        pp.load("insitu_at_plot", insitu_at_plot, false);
+        if (pp.contains("insitu_var"))
+            pp.load("insitu_var", insitu_var_name);
+        else
+            insitu_var_name = "chi";
+        insitu_var = UserVariables::variable_name_to_enum(insitu_var_name);
+        insitu_var_type = VariableType::evolution;
+        if (insitu_var < 0)
+        {
+            insitu_var =
+                DiagnosticVariables::variable_name_to_enum(insitu_var_name);
+            insitu_var_type = VariableType::diagnostic;
+        }
+        pp.load("insitu_min", insitu_min, 0.);
+        pp.load("insitu_max", insitu_max, 1.);
+        pp.load("insitu_histogram_bins", insitu_histogram_bins, 50);
+        pp.load("insitu_slice_normal_dir", insitu_slice_normal_dir, 2);
+        // (the direction is checked below)
+        const int slice_dir =
+            std::min(std::max(insitu_slice_normal_dir, 0), CH_SPACEDIM - 1);
+        pp.load("insitu_slice_position", insitu_slice_position,
+                center[slice_dir]);
+        pp.load("insitu_slice_pixels", insitu_slice_pixels, 512);
     }
 
 #ifdef USE_TWOPUNCTURES
@@ -293,11 +329,41 @@ class SimulationParameters : public SimulationParametersBase
                         (puncture_tracking_level >= 0) &&
                             (puncture_tracking_level <= max_level),
                         "must be between 0 and max_level (inclusive)");
+        check_parameter("insitu_interval", insitu_interval,
+                        insitu_interval >= 0, "must be >= 0");
+        if (insitu_interval > 0 || insitu_at_plot)
+        {
+            check_parameter("insitu_var", insitu_var_name, insitu_var >= 0,
+                            "must be an evolution or diagnostic variable");
+            check_parameter("insitu_max", insitu_max, insitu_max > insitu_min,
+                            "must be > insitu_min");
+            check_parameter("insitu_histogram_bins", insitu_histogram_bins,
+                            insitu_histogram_bins >= 1, "must be >= 1");
+            check_parameter("insitu_slice_normal_dir", insitu_slice_normal_dir,
+                            insitu_slice_normal_dir >= 0 &&
+                                insitu_slice_normal_dir < CH_SPACEDIM,
+                            "must be a direction");
+            check_parameter("insitu_slice_pixels", insitu_slice_pixels,
+                            insitu_slice_pixels >= 1, "must be >= 1");
+        }
     }
 
     bool track_punctures, calculate_constraint_norms;
+    bool constraints_on_all_levels_at_once;
+    bool predictive_puncture_tagging;
     int puncture_tracking_level;
 
+    int insitu_interval;
+    bool insitu_at_plot;
+    std::string insitu_var_name;
+    int insitu_var;
+    VariableType insitu_var_type;
+    double insitu_min, insitu_max;
+    int insitu_histogram_bins;
+    int insitu_slice_normal_dir;
+    double insitu_slice_position;
+    int insitu_slice_pixels;
+
     // Collection of parameters necessary for initial conditions
     // Set these even in the case of TwoPunctures as they are used elsewhere
     // e.g. for puncture tracking/tagging
@@ -38,6 +38,10 @@ void KerrBHLevel::initialData()
     if (m_verbosity)
         pout() << "KerrBHLevel::initialData " << m_level << endl;
 
+    // take the data from a checkpoint at another resolution if warm starting
+    if (warmStartData())
+        return;
+
     // First set everything to zero then calculate initial data  Get the Kerr
     // solution in the variables, then calculate the \tilde\Gamma^i numerically
     // as these are non zero and not calculated in the Kerr ICs
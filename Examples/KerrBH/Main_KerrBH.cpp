@@ -40,6 +40,13 @@ int runGRChombo(int argc, char *argv[])
     DefaultLevelFactory<KerrBHLevel> kerr_bh_level_fact(gr_amr, sim_params);
     setupAMRObject(gr_amr, kerr_bh_level_fact);
 
+    // estimate the cost of the run from the initial hierarchy and stop
+    if (sim_params.dry_run)
+    {
+        gr_amr.dry_run(sim_params.dry_run_num_ranks);
+        return 0;
+    }
+
     using Clock = std::chrono::steady_clock;
     using Minutes = std::chrono::duration<double, std::ratio<60, 1>>;
 
@@ -41,6 +41,13 @@ int runGRChombo(int argc, char *argv[])
                                                                   sim_params);
     setupAMRObject(gr_amr, scalar_field_level_fact);
 
+    // estimate the cost of the run from the initial hierarchy and stop
+    if (sim_params.dry_run)
+    {
+        gr_amr.dry_run(sim_params.dry_run_num_ranks);
+        return 0;
+    }
+
     // Engage! Run the evolution
     gr_amr.run(sim_params.stop_time, sim_params.max_steps);
     gr_amr.conclude();
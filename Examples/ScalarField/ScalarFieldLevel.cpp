@@ -51,6 +51,10 @@ void ScalarFieldLevel::initialData()
     if (m_verbosity)
         pout() << "ScalarFieldLevel::initialData " << m_level << endl;
 
+    // take the data from a checkpoint at another resolution if warm starting
+    if (warmStartData())
+        return;
+
     // First set everything to zero then initial conditions for scalar field -
     // here a Kerr BH and a scalar field profile
     BoxLoops::loop(
@@ -8,6 +8,8 @@
 
 // system includes
 
+#include <algorithm>
+#include <array>
 #include <limits>
 
 // Chombo includes
@@ -46,6 +48,10 @@ template <typename InterpAlgo> class AMRInterpolator
 
     void refresh(const bool a_fill_ghosts = true);
 
+    // refresh without filling ghosts and leave it to interp to fill only
+    // those of the queried components on the levels that own query points
+    void refresh_on_demand();
+
     // if not filling ghosts in refresh, call this explicitly for required vars
     void fill_multilevel_ghosts(
         const VariableType a_var_type,
@@ -66,6 +72,7 @@ template <typename InterpAlgo> class AMRInterpolator
     void prepareMPI(InterpolationQuery &query,
                     const InterpolationLayout layout);
     void exchangeMPIQuery();
+    void fillGhostsOnDemand(InterpolationQuery &query);
     void calculateAnswers(InterpolationQuery &query);
     void exchangeMPIAnswer();
 
@@ -110,6 +117,11 @@ template <typename InterpAlgo> class AMRInterpolator
     std::vector<double> m_answer_coords[CH_SPACEDIM];
     std::vector<std::vector<double>> m_answer_data;
 
+    // Whether interp fills the ghosts it needs and which [level][comp] ghosts
+    // it has filled since the last refresh (for each VariableType)
+    bool m_fill_ghosts_on_demand;
+    std::array<std::vector<std::vector<bool>>, 2> m_ghosts_filled;
+
     // A bit of Android-ism here, but it's really useful!
     // Identifies the printout as originating from this class.
     const static string TAG;
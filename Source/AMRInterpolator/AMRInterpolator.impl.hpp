@@ -31,7 +31,8 @@ AMRInterpolator<InterpAlgo>::AMRInterpolator(
     : m_gr_amr(gr_amr), m_coarsest_origin(coarsest_origin),
       m_coarsest_dx(coarsest_dx),
       m_num_levels(const_cast<GRAMR &>(m_gr_amr).getAMRLevels().size()),
-      m_verbosity(verbosity), m_bc_params(a_bc_params)
+      m_verbosity(verbosity), m_fill_ghosts_on_demand(false),
+      m_bc_params(a_bc_params)
 {
     set_reflective_BC();
 }
@@ -48,6 +49,7 @@ void AMRInterpolator<InterpAlgo>::refresh(const bool a_fill_ghosts)
     m_mem_level.clear();
     m_mem_box.clear();
 
+    m_fill_ghosts_on_demand = false;
     if (a_fill_ghosts)
     {
         fill_multilevel_ghosts(VariableType::evolution);
@@ -56,6 +58,18 @@ void AMRInterpolator<InterpAlgo>::refresh(const bool a_fill_ghosts)
     }
 }
 
+template <typename InterpAlgo>
+void AMRInterpolator<InterpAlgo>::refresh_on_demand()
+{
+    refresh(false);
+
+    m_fill_ghosts_on_demand = true;
+    m_ghosts_filled[static_cast<int>(VariableType::evolution)].assign(
+        m_num_levels, std::vector<bool>(NUM_VARS, false));
+    m_ghosts_filled[static_cast<int>(VariableType::diagnostic)].assign(
+        m_num_levels, std::vector<bool>(NUM_DIAGNOSTIC_VARS, false));
+}
+
 template <typename InterpAlgo>
 void AMRInterpolator<InterpAlgo>::fill_multilevel_ghosts(
     const VariableType a_var_type, const Interval &a_comps,
@@ -145,6 +159,8 @@ void AMRInterpolator<InterpAlgo>::interp(InterpolationQuery &query)
     prepareMPI(query, interp_layout);
     // Calculate interpolated values
     exchangeMPIQuery();
+    if (m_fill_ghosts_on_demand)
+        fillGhostsOnDemand(query);
     calculateAnswers(query);
     exchangeMPIAnswer();
 
@@ -612,6 +628,84 @@ void AMRInterpolator<InterpAlgo>::exchangeMPIQuery()
     }
 }
 
+// Fills the ghosts of the queried components on the levels which own at least
+// one query point (on any rank). Filling is collective and is done for whole
+// levels (the copiers and coarse-fine interpolation are defined per level).
+template <typename InterpAlgo>
+void AMRInterpolator<InterpAlgo>::fillGhostsOnDemand(InterpolationQuery &query)
+{
+    CH_TIME("AMRInterpolator::fillGhostsOnDemand");
+
+    // flags for the levels, then the evolution and diagnostic components
+    const int num_levels = m_ghosts_filled[0].size();
+    const int evolution_offset = num_levels;
+    const int diagnostic_offset = evolution_offset + NUM_VARS;
+    std::vector<int> needed(diagnostic_offset + NUM_DIAGNOSTIC_VARS, 0);
+
+    const int num_answers = m_mpi.totalAnswerCount();
+    for (int answer_idx = 0; answer_idx < num_answers; ++answer_idx)
+        needed[m_answer_level[answer_idx]] = 1;
+
+    for (typename InterpolationQuery::iterator deriv_it = query.compsBegin();
+         deriv_it != query.compsEnd(); ++deriv_it)
+    {
+        for (const auto &out : deriv_it->second)
+        {
+            const int comp = std::get<0>(out);
+            const VariableType type = std::get<2>(out);
+            if (type == VariableType::evolution)
+                needed[evolution_offset + comp] = 1;
+            else
+                needed[diagnostic_offset + comp] = 1;
+        }
+    }
+
+#ifdef CH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, needed.data(), needed.size(), MPI_INT,
+                  MPI_MAX, Chombo_MPI::comm);
+#endif
+
+    for (const VariableType type :
+         {VariableType::evolution, VariableType::diagnostic})
+    {
+        const int offset = (type == VariableType::evolution)
+                               ? evolution_offset
+                               : diagnostic_offset;
+        std::vector<std::vector<bool>> &filled =
+            m_ghosts_filled[static_cast<int>(type)];
+        for (int level_idx = 0; level_idx < num_levels; ++level_idx)
+        {
+            if (!needed[level_idx])
+                continue;
+
+            // fill the range spanning the components not yet filled
+            int comp_min = std::numeric_limits<int>::max();
+            int comp_max = -1;
+            for (int comp = 0; comp < filled[level_idx].size(); ++comp)
+            {
+                if (needed[offset + comp] && !filled[level_idx][comp])
+                {
+                    comp_min = std::min(comp_min, comp);
+                    comp_max = comp;
+                }
+            }
+            if (comp_max < 0)
+                continue;
+
+            if (m_verbosity)
+            {
+                pout() << TAG << "Filling ghosts of components " << comp_min
+                       << "-" << comp_max << " on level " << level_idx
+                       << endl;
+            }
+            fill_multilevel_ghosts(type, Interval(comp_min, comp_max),
+                                   level_idx, level_idx);
+            for (int comp = comp_min; comp <= comp_max; ++comp)
+                filled[level_idx][comp] = true;
+        }
+    }
+}
+
 template <typename InterpAlgo>
 void AMRInterpolator<InterpAlgo>::calculateAnswers(InterpolationQuery &query)
 {
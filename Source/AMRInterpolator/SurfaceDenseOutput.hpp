@@ -0,0 +1,207 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef SURFACEDENSEOUTPUT_HPP_
+#define SURFACEDENSEOUTPUT_HPP_
+
+// Other includes
+#include <array>
+#include <cmath>
+#include <deque>
+#include <vector>
+
+/// Interpolates extracted surface data in time so that it can be output at a
+/// uniform cadence which is finer than that of the extraction
+/**
+ * Each sample is the data of a SurfaceExtraction (indexed by [var][point]) at
+ * the time it was extracted. Between the last two samples, the data is
+ * interpolated with a cubic Hermite polynomial whose time derivatives come
+ * from the quadratic through the last three samples (so no extra samples are
+ * needed to output up to the latest one). With only two samples this reduces
+ * to linear interpolation.
+ */
+class SurfaceDenseOutput
+{
+  public:
+    using data_t = std::vector<std::vector<double>>;
+
+    SurfaceDenseOutput(double a_output_dt = 0.)
+        : m_output_dt(a_output_dt), m_next_output_index(0)
+    {
+    }
+
+    void set_output_dt(double a_output_dt)
+    {
+        m_output_dt = a_output_dt;
+        reset();
+    }
+
+    double get_output_dt() const { return m_output_dt; }
+
+    //! Discard the samples (e.g. if the time goes backwards)
+    void reset()
+    {
+        m_times.clear();
+        m_samples.clear();
+        m_next_output_index = 0;
+    }
+
+    //! Add the extracted data at a_time and return the output times (the
+    //! multiples of the output dt) which can now be interpolated
+    std::vector<double> add_sample(double a_time, data_t a_data)
+    {
+        const double eps = 1e-8 * m_output_dt;
+        if (!m_times.empty() && a_time <= m_times.back() + eps)
+            reset();
+
+        m_times.push_back(a_time);
+        m_samples.push_back(std::move(a_data));
+        if (m_times.size() > 3)
+        {
+            m_times.pop_front();
+            m_samples.pop_front();
+        }
+
+        // the first sample is only output if it is at an output time
+        if (m_times.size() == 1)
+            m_next_output_index = std::ceil(a_time / m_output_dt - 1e-8);
+
+        std::vector<double> output_times;
+        while (m_next_output_index * m_output_dt <= a_time + eps)
+        {
+            output_times.push_back(m_next_output_index * m_output_dt);
+            ++m_next_output_index;
+        }
+        return output_times;
+    }
+
+    //! Start again from the data extracted at a_time (e.g. a restart time)
+    //! whose output times have already been written
+    void seed(double a_time, data_t a_data)
+    {
+        reset();
+        m_times.push_back(a_time);
+        m_samples.push_back(std::move(a_data));
+        m_next_output_index = std::floor(a_time / m_output_dt + 1e-8) + 1;
+    }
+
+    //! The samples and the next output time as one vector (e.g. to store
+    //! them in an in-memory checkpoint)
+    std::vector<double> get_state() const
+    {
+        std::vector<double> state = {static_cast<double>(m_next_output_index),
+                                     static_cast<double>(m_times.size())};
+        for (int isample = 0; isample < m_times.size(); ++isample)
+        {
+            const data_t &sample = m_samples[isample];
+            state.push_back(m_times[isample]);
+            state.push_back(sample.size());
+            for (const std::vector<double> &var_data : sample)
+            {
+                state.push_back(var_data.size());
+                state.insert(state.end(), var_data.begin(), var_data.end());
+            }
+        }
+        return state;
+    }
+
+    //! Restore the samples from a vector given by get_state (which need not
+    //! start at its beginning). Returns the position after the state.
+    std::vector<double>::const_iterator
+    set_state(std::vector<double>::const_iterator a_state)
+    {
+        reset();
+        m_next_output_index = static_cast<long long>(*a_state++);
+        const int num_samples = static_cast<int>(*a_state++);
+        for (int isample = 0; isample < num_samples; ++isample)
+        {
+            m_times.push_back(*a_state++);
+            data_t sample(static_cast<int>(*a_state++));
+            for (std::vector<double> &var_data : sample)
+            {
+                const int num_points = static_cast<int>(*a_state++);
+                var_data.assign(a_state, a_state + num_points);
+                a_state += num_points;
+            }
+            m_samples.push_back(std::move(sample));
+        }
+        return a_state;
+    }
+
+    //! The data interpolated to a time between the last two samples
+    data_t interpolate(double a_time) const
+    {
+        const int num_samples = m_times.size();
+        if (num_samples == 1)
+            return m_samples.back();
+
+        const double t0 = m_times[num_samples - 2];
+        const double t1 = m_times[num_samples - 1];
+        const data_t &v0 = m_samples[num_samples - 2];
+        const data_t &v1 = m_samples[num_samples - 1];
+        const double h = t1 - t0;
+        const double s = (a_time - t0) / h;
+
+        // Hermite basis functions
+        const double h00 = (1. + 2. * s) * (1. - s) * (1. - s);
+        const double h10 = s * (1. - s) * (1. - s);
+        const double h01 = s * s * (3. - 2. * s);
+        const double h11 = s * s * (s - 1.);
+
+        // weights of the samples in the derivatives at t0 and t1
+        std::array<double, 3> d0_weights = {0., -1. / h, 1. / h};
+        std::array<double, 3> d1_weights = d0_weights;
+        if (num_samples == 3)
+        {
+            d0_weights = quadratic_derivative_weights(t0);
+            d1_weights = quadratic_derivative_weights(t1);
+        }
+
+        data_t out(v1.size());
+        for (int ivar = 0; ivar < v1.size(); ++ivar)
+        {
+            out[ivar].resize(v1[ivar].size());
+            for (int ipoint = 0; ipoint < v1[ivar].size(); ++ipoint)
+            {
+                double d0 = 0.;
+                double d1 = 0.;
+                for (int isample = 3 - num_samples; isample < 3; ++isample)
+                {
+                    const double value =
+                        m_samples[isample - 3 + num_samples][ivar][ipoint];
+                    d0 += d0_weights[isample] * value;
+                    d1 += d1_weights[isample] * value;
+                }
+                out[ivar][ipoint] = h00 * v0[ivar][ipoint] + h10 * h * d0 +
+                                    h01 * v1[ivar][ipoint] + h11 * h * d1;
+            }
+        }
+        return out;
+    }
+
+  private:
+    double m_output_dt;
+    long long m_next_output_index; //!< the next multiple of m_output_dt
+    std::deque<double> m_times;
+    std::deque<data_t> m_samples;
+
+    //! The weights of the three samples in the derivative at a_time of the
+    //! quadratic through them
+    std::array<double, 3> quadratic_derivative_weights(double a_time) const
+    {
+        std::array<double, 3> weights;
+        for (int i = 0; i < 3; ++i)
+        {
+            const double ti = m_times[i];
+            const double tj = m_times[(i + 1) % 3];
+            const double tk = m_times[(i + 2) % 3];
+            weights[i] =
+                ((a_time - tj) + (a_time - tk)) / ((ti - tj) * (ti - tk));
+        }
+        return weights;
+    }
+};
+
+#endif /* SURFACEDENSEOUTPUT_HPP_ */
@@ -50,6 +50,9 @@ template <class SurfaceGeometry> class SurfaceExtraction
         std::vector<int> extraction_levels; //!< the level on which to do the
                                             //!< extraction for each surface
         bool write_extraction; //!< whether or not to write the extracted data
+        double dense_output_dt = 0.; //!< if > 0, the extracted data is
+                                     //!< interpolated in time and output
+                                     //!< with this spacing
 
         std::string data_path, integral_file_prefix;
         std::string extraction_path, extraction_file_prefix;
@@ -142,6 +145,16 @@ template <class SurfaceGeometry> class SurfaceExtraction
     template <typename InterpAlgo>
     void extract(AMRInterpolator<InterpAlgo> *a_interpolator);
 
+    //! The extracted data (indexed by [var][point]; empty on ranks > 0)
+    const std::vector<std::vector<double>> &get_interp_data() const
+    {
+        return m_interp_data;
+    }
+
+    //! Use the given data (e.g. interpolated in time by a SurfaceDenseOutput)
+    //! instead of calling extract
+    void set_interp_data(std::vector<std::vector<double>> a_interp_data);
+
     //! Add an integrand dependent on the interpolated data over the surface
     //! for integrate() to integrate over.
     //! Note the area_element is already included from the SurfaceGeometry
@@ -161,6 +161,15 @@ void SurfaceExtraction<SurfaceGeometry>::extract(
     m_done_extraction = true;
 }
 
+template <class SurfaceGeometry>
+void SurfaceExtraction<SurfaceGeometry>::set_interp_data(
+    std::vector<std::vector<double>> a_interp_data)
+{
+    CH_assert(a_interp_data.size() == m_vars.size());
+    m_interp_data = std::move(a_interp_data);
+    m_done_extraction = true;
+}
+
 //! Add an integrand (which must of type integrand_t) for integrate() to
 //! integrate over. Note the area_element is already included from the
 //! SurfaceGeometry template class
@@ -6,8 +6,11 @@
 #ifndef BHAMR_HPP_
 #define BHAMR_HPP_
 
+#include "DiagnosticsSnapshot.hpp"
 #include "GRAMR.hpp"
 #include "PunctureTracker.hpp"
+#include "SurfaceDenseOutput.hpp"
+#include <memory>
 
 /// A child of Chombo's AMR class to interface with tools which require
 /// access to the whole AMR hierarchy, and those of GRAMR
@@ -19,6 +22,15 @@ class BHAMR : public GRAMR
   public:
     PunctureTracker m_puncture_tracker;
 
+    //! Interpolates the Weyl scalars extracted on the surfaces in time if
+    //! extraction_dense_output_dt is set
+    SurfaceDenseOutput m_weyl_dense_output;
+
+    //! The levels taken so far at the end of the current coarse step to
+    //! compute the constraints on in the background (if async_diagnostics
+    //! is set)
+    std::shared_ptr<DiagnosticsSnapshot> m_constraints_snapshot;
+
     BHAMR() {}
 
     void set_interpolator(AMRInterpolator<Lagrange<4>> *a_interpolator) override
@@ -26,6 +38,35 @@ class BHAMR : public GRAMR
         GRAMR::set_interpolator(a_interpolator);
         m_puncture_tracker.set_interpolator(a_interpolator);
     }
+
+  protected:
+    void specific_write_memory_checkpoint(
+        std::vector<double> &a_extra_data) const override
+    {
+        a_extra_data = m_puncture_tracker.get_state();
+        a_extra_data.insert(a_extra_data.begin(), a_extra_data.size());
+        // the dense output samples are needed to output the times between
+        // the checkpoint and the next extraction (they are only non-empty on
+        // rank 0 which does the output)
+        const std::vector<double> dense_output_state =
+            m_weyl_dense_output.get_state();
+        a_extra_data.insert(a_extra_data.end(), dense_output_state.begin(),
+                            dense_output_state.end());
+    }
+
+    void specific_read_memory_checkpoint(
+        const std::vector<double> &a_extra_data) override
+    {
+        const int num_puncture_values = static_cast<int>(a_extra_data[0]);
+        if (num_puncture_values > 0)
+        {
+            m_puncture_tracker.set_state(std::vector<double>(
+                a_extra_data.begin() + 1,
+                a_extra_data.begin() + 1 + num_puncture_values));
+        }
+        m_weyl_dense_output.set_state(a_extra_data.begin() + 1 +
+                                      num_puncture_values);
+    }
 };
 
 #endif /* BHAMR_HPP_ */
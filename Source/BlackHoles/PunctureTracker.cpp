@@ -161,6 +161,8 @@ void PunctureTracker::execute_tracking(double a_time, double a_restart_time,
         }
     }
 
+    check_predicted_regions(a_time);
+
     // print them out
     if (write_punctures)
     {
@@ -174,6 +176,140 @@ void PunctureTracker::execute_tracking(double a_time, double a_restart_time,
     }
 }
 
+std::vector<double> PunctureTracker::get_state() const
+{
+    std::vector<double> state;
+    state.reserve(2 * m_num_punctures * CH_SPACEDIM);
+    for (const auto &coords : m_puncture_coords)
+        state.insert(state.end(), coords.begin(), coords.end());
+    for (const auto &shift : m_puncture_shift)
+        state.insert(state.end(), shift.begin(), shift.end());
+    return state;
+}
+
+void PunctureTracker::set_state(const std::vector<double> &a_state)
+{
+    // the shift is only known once the tracking has been executed
+    const int num_values = m_num_punctures * CH_SPACEDIM;
+    CH_assert(a_state.size() == num_values ||
+              a_state.size() == 2 * num_values);
+    for (int ipuncture = 0; ipuncture < m_num_punctures; ++ipuncture)
+    {
+        FOR1(i)
+        {
+            m_puncture_coords[ipuncture][i] =
+                a_state[ipuncture * CH_SPACEDIM + i];
+        }
+    }
+    if (a_state.size() == 2 * num_values)
+    {
+        m_puncture_shift.resize(m_num_punctures);
+        for (int ipuncture = 0; ipuncture < m_num_punctures; ++ipuncture)
+        {
+            FOR1(i)
+            {
+                m_puncture_shift[ipuncture][i] =
+                    a_state[num_values + ipuncture * CH_SPACEDIM + i];
+            }
+        }
+    }
+}
+
+std::vector<std::array<double, CH_SPACEDIM>>
+PunctureTracker::get_puncture_velocities() const
+{
+    // the punctures are advected by minus the shift
+    std::vector<std::array<double, CH_SPACEDIM>> puncture_velocities(
+        m_puncture_shift.size());
+    for (int ipuncture = 0; ipuncture < m_puncture_shift.size(); ipuncture++)
+    {
+        FOR1(i)
+        {
+            puncture_velocities[ipuncture][i] =
+                -m_puncture_shift[ipuncture][i];
+        }
+    }
+    return puncture_velocities;
+}
+
+std::vector<std::array<double, CH_SPACEDIM>>
+PunctureTracker::get_predicted_puncture_coords(double a_delta_t) const
+{
+    std::vector<std::array<double, CH_SPACEDIM>> predicted_coords =
+        m_puncture_coords;
+    const auto puncture_velocities = get_puncture_velocities();
+    for (int ipuncture = 0; ipuncture < puncture_velocities.size();
+         ipuncture++)
+    {
+        FOR1(i)
+        {
+            predicted_coords[ipuncture][i] +=
+                a_delta_t * puncture_velocities[ipuncture][i];
+        }
+    }
+    return predicted_coords;
+}
+
+void PunctureTracker::set_predicted_regions(
+    const std::vector<std::array<double, CH_SPACEDIM>> &a_predicted_coords,
+    const std::vector<double> &a_radii, double a_until_time)
+{
+    CH_assert(a_predicted_coords.size() == m_puncture_coords.size());
+    CH_assert(a_radii.size() == m_puncture_coords.size());
+    m_predicted_start_coords = m_puncture_coords;
+    m_predicted_end_coords = a_predicted_coords;
+    m_predicted_radii = a_radii;
+    m_predicted_until_time = a_until_time;
+    m_left_predicted_region.assign(m_puncture_coords.size(), false);
+}
+
+void PunctureTracker::check_predicted_regions(double a_time)
+{
+    if (a_time > m_predicted_until_time)
+        return;
+
+    for (int ipuncture = 0; ipuncture < m_predicted_radii.size(); ipuncture++)
+    {
+        if (m_left_predicted_region[ipuncture])
+            continue;
+
+        // distance from the puncture to the predicted segment
+        std::array<double, CH_SPACEDIM> segment, offset;
+        double segment_length2 = 0.;
+        double projection = 0.;
+        FOR1(i)
+        {
+            segment[i] = m_predicted_end_coords[ipuncture][i] -
+                         m_predicted_start_coords[ipuncture][i];
+            offset[i] = m_puncture_coords[ipuncture][i] -
+                        m_predicted_start_coords[ipuncture][i];
+            segment_length2 += segment[i] * segment[i];
+            projection += offset[i] * segment[i];
+        }
+        const double t = (segment_length2 > 0.)
+                             ? std::min(1., std::max(0., projection /
+                                                             segment_length2))
+                             : 0.;
+        double distance2 = 0.;
+        FOR1(i)
+        {
+            const double diff = offset[i] - t * segment[i];
+            distance2 += diff * diff;
+        }
+
+        if (distance2 > m_predicted_radii[ipuncture] *
+                            m_predicted_radii[ipuncture])
+        {
+            m_left_predicted_region[ipuncture] = true;
+            pout() << "PunctureTracker: puncture " << ipuncture
+                   << " left its predicted region at time " << a_time
+                   << " (distance " << sqrt(distance2) << " > "
+                   << m_predicted_radii[ipuncture]
+                   << "), the finest level may not cover its horizon" << endl;
+        }
+    }
+}
+
 //! Use the interpolator to get the value of the shift at
 //! given coords
 void PunctureTracker::interp_shift()
@@ -182,12 +318,9 @@ void PunctureTracker::interp_shift()
     // resize the vector to the number of punctures
     m_puncture_shift.resize(m_num_punctures);
 
-    // refresh interpolator
-    bool fill_ghosts = false;
-    m_interpolator->refresh(fill_ghosts);
-    // only fill the ghosts we need
-    m_interpolator->fill_multilevel_ghosts(
-        VariableType::evolution, Interval(c_shift1, c_shift3), m_min_level);
+    // refresh interpolator (only the shift ghosts around the punctures are
+    // filled when interpolating)
+    m_interpolator->refresh_on_demand();
 
     // set up shift and coordinate holders
     std::vector<double> interp_shift1(m_num_punctures);
@@ -22,6 +22,14 @@ class PunctureTracker
     int m_min_level; //!< the min level on which punctures will be
                      //!< (to fill ghosts)
 
+    //! The regions the punctures are predicted to stay in (capsules around
+    //! the segments from the start to the end coords) until a given time
+    std::vector<std::array<double, CH_SPACEDIM>> m_predicted_start_coords;
+    std::vector<std::array<double, CH_SPACEDIM>> m_predicted_end_coords;
+    std::vector<double> m_predicted_radii;
+    double m_predicted_until_time;
+    std::vector<bool> m_left_predicted_region; //!< so we only warn once
+
     std::string m_punctures_filename;
 
     // saved pointer to external interpolator
@@ -29,7 +37,11 @@ class PunctureTracker
 
   public:
     //! The constructor
-    PunctureTracker() : m_num_punctures(0), m_interpolator(nullptr) {}
+    PunctureTracker()
+        : m_num_punctures(0), m_predicted_until_time(0.),
+          m_interpolator(nullptr)
+    {
+    }
 
     //! set puncture locations on start (or restart)
     //! this needs to be done before 'setupAMRObject'
@@ -60,6 +72,29 @@ class PunctureTracker
         return m_puncture_coords;
     }
 
+    //! the coordinate velocity of each puncture (minus the shift there)
+    std::vector<std::array<double, CH_SPACEDIM>>
+    get_puncture_velocities() const;
+
+    //! the puncture coords extrapolated a_delta_t ahead with their current
+    //! velocities
+    std::vector<std::array<double, CH_SPACEDIM>>
+    get_predicted_puncture_coords(double a_delta_t) const;
+
+    //! Remember that each puncture is expected to stay within a_radii of the
+    //! segment from its current to its a_predicted_coords until a_until_time.
+    //! A warning is printed if it leaves this region before then.
+    void set_predicted_regions(
+        const std::vector<std::array<double, CH_SPACEDIM>> &a_predicted_coords,
+        const std::vector<double> &a_radii, double a_until_time);
+
+    //! The puncture coords and shifts as one vector (e.g. to store them in
+    //! an in-memory checkpoint)
+    std::vector<double> get_state() const;
+
+    //! Restore the coords and shifts from a vector given by get_state
+    void set_state(const std::vector<double> &a_state);
+
   private:
     //! set and write initial puncture locations
     void set_initial_punctures();
@@ -71,6 +106,9 @@ class PunctureTracker
     //! given coords
     void interp_shift();
 
+    //! Warn if any puncture has left its predicted region
+    void check_predicted_regions(double a_time);
+
     //! Get a vector of the puncture coords - used for write out
     std::vector<double> get_puncture_vector() const;
 };
@@ -83,6 +83,20 @@ template <typename compute_t, typename... simd_info>
 std::enable_if_t<!is_compute_pack<compute_t>::value, void>
 loop(compute_t compute_class, const LevelData<FArrayBox> &in,
      LevelData<FArrayBox> &out, bool fill_ghosts, simd_info... info);
+
+/// Same as above but fills the boxes grown by a_ghosts_to_fill (restricted to
+/// the boxes of 'out'), e.g. for a redundant computation in the ghosts
+template <typename... compute_ts, typename... simd_info>
+void loop(const ComputePack<compute_ts...> &compute_pack,
+          const LevelData<FArrayBox> &in, LevelData<FArrayBox> &out,
+          const IntVect &a_ghosts_to_fill, simd_info... info);
+
+/// Same as above but for only one compute class (rather than a pack of them)
+template <typename compute_t, typename... simd_info>
+std::enable_if_t<!is_compute_pack<compute_t>::value, void>
+loop(compute_t compute_class, const LevelData<FArrayBox> &in,
+     LevelData<FArrayBox> &out, const IntVect &a_ghosts_to_fill,
+     simd_info... info);
 } // namespace BoxLoops
 
 #include "BoxLoops.impl.hpp"
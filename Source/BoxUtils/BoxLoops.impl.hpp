@@ -146,4 +146,35 @@ BoxLoops::loop(compute_t compute_class, const LevelData<FArrayBox> &in,
          std::forward<simd_info>(info)...);
 }
 
+template <typename... compute_ts, typename... simd_info>
+void BoxLoops::loop(const ComputePack<compute_ts...> &compute_pack,
+                    const LevelData<FArrayBox> &in, LevelData<FArrayBox> &out,
+                    const IntVect &a_ghosts_to_fill, simd_info... info)
+{
+    DataIterator dit0 = in.dataIterator();
+    int nbox = dit0.size();
+    for (int ibox = 0; ibox < nbox; ++ibox)
+    {
+        DataIndex di = dit0[ibox];
+        const FArrayBox &in_fab = in[di];
+        FArrayBox &out_fab = out[di];
+
+        Box out_box = grow(in.disjointBoxLayout()[di], a_ghosts_to_fill);
+        out_box &= out_fab.box();
+
+        loop(compute_pack, in_fab, out_fab, out_box,
+             std::forward<simd_info>(info)...);
+    }
+}
+
+template <typename compute_t, typename... simd_info>
+std::enable_if_t<!is_compute_pack<compute_t>::value, void>
+BoxLoops::loop(compute_t compute_class, const LevelData<FArrayBox> &in,
+               LevelData<FArrayBox> &out, const IntVect &a_ghosts_to_fill,
+               simd_info... info)
+{
+    loop(make_compute_pack(compute_class), in, out, a_ghosts_to_fill,
+         std::forward<simd_info>(info)...);
+}
+
 #endif /* BOXLOOPS_IMPL_HPP_ */
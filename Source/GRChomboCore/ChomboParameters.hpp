@@ -44,6 +44,13 @@ class ChomboParameters
                 4);
         pp.load("num_ghosts", num_ghosts,
                 (max_spatial_derivative_order == 6) ? 4 : 3);
+        // RK stages per ghost exchange (the state is allocated with this many
+        // times num_ghosts ghosts which are updated redundantly in between)
+        pp.load("deep_halo_stages", deep_halo_stages, 1);
+        // keep the interpolated coarse-fine ghosts of each time interpolation
+        // coefficient for the later RK stages of the coarse step (at the cost
+        // of up to 5 copies of the coarse-fine ghost shell of each level)
+        pp.load("cache_coarse_fine_ghosts", cache_coarse_fine_ghosts, false);
         pp.load("tag_buffer_size", tag_buffer_size, 3);
         pp.load("grid_buffer_size", grid_buffer_size, 8);
         pp.load("dt_multiplier", dt_multiplier, 0.25);
@@ -97,6 +104,11 @@ class ChomboParameters
         pp.load("max_steps", max_steps, 1000000);
 #ifdef CH_USE_HDF5
         pp.load("write_plot_ghosts", write_plot_ghosts, false);
+        // write every level of the plot files at plot_coarsen_factors[level]
+        // times its dx, averaging (or subsampling) the cells
+        pp.load("plot_coarsen_factors", plot_coarsen_factors, max_level + 1,
+                1);
+        pp.load("plot_coarsen_average", plot_coarsen_average, true);
 
         // load vars to write to plot files
         UserVariables::load_vars_to_vector(pp, "plot_vars", "num_plot_vars",
@@ -121,11 +133,89 @@ class ChomboParameters
             pp.load("min_box_size", block_factor, 8);
         }
 
+        // time trial RHS evaluations on the initial hierarchy split into
+        // boxes of each of these sizes and recommend (or apply) the fastest
+        pp.load("autotune_box_size", autotune_box_size, false);
+        if (autotune_box_size)
+        {
+            const std::vector<int> default_box_sizes = {16, 32, 64};
+            pp.load("num_autotune_box_sizes", num_autotune_box_sizes,
+                    static_cast<int>(default_box_sizes.size()));
+            pp.load("autotune_box_sizes", autotune_box_sizes,
+                    num_autotune_box_sizes, default_box_sizes);
+            pp.load("autotune_num_trials", autotune_num_trials, 3);
+            pp.load("autotune_apply", autotune_apply, false);
+        }
+
+        // put levels with fewer than this many boxes per rank on a subset of
+        // the ranks (0 means all levels use all ranks)
+        pp.load("agglomeration_boxes_per_rank", agglomeration_boxes_per_rank,
+                0);
+
+        // on regrids, a level is interpolated only where it was not refined
+        // before unless more than this fraction of it is newly refined, in
+        // which case the whole level is interpolated (and the old data kept
+        // where it exists). 0 always interpolates the whole level
+        pp.load("regrid_max_uncovered_fraction", regrid_max_uncovered_fraction,
+                0.5);
+
+        // back the field data with transparent huge pages (Linux only)
+        pp.load("use_huge_pages", use_huge_pages, false);
+
         if (pp.contains("check_params"))
             just_check_params = true;
 
+        // build the initial grids (see GRAMR::set_dry_run), print the
+        // expected cost of the run on dry_run_num_ranks ranks (0 means the
+        // current number) and stop
+        pp.load("dry_run", dry_run, false);
+        pp.load("dry_run_num_ranks", dry_run_num_ranks, 0);
+
         pp.load("print_progress_only_to_rank_0", print_progress_only_to_rank_0,
                 false);
+
+        // do the diagnostics work that needs no communication (e.g. the
+        // rank 0 integration and output) on a background thread
+        pp.load("async_diagnostics", async_diagnostics, false);
+
+        // keep small data output (extraction, integrals, ...) in memory and
+        // write it every this many coarse steps and at checkpoints (0 writes
+        // it immediately)
+        pp.load("small_data_flush_interval", small_data_flush_interval, 0);
+
+        // write the time spent in each phase of a regrid and how much the
+        // grids changed to data files
+        pp.load("write_regrid_stats", write_regrid_stats, false);
+
+        // checkpoint and stop when there would be less than
+        // walltime_safety_margin left of the job's walltime_limit (both in
+        // hours) after the next coarse step and checkpoint (0 disables this)
+        pp.load("walltime_limit", walltime_limit, 0.);
+        pp.load("walltime_safety_margin", walltime_safety_margin, 0.05);
+        // the rate (in MB/s) to assume checkpoints are written at until one
+        // has been timed
+        pp.load("walltime_checkpoint_rate", walltime_checkpoint_rate, 100.);
+        // checkpoint and stop after the current coarse step on SIGUSR1 or
+        // SIGTERM
+        pp.load("checkpoint_on_signal", checkpoint_on_signal, false);
+
+        // keep a copy of the hierarchy in memory (and of each rank's data on
+        // another rank) every this many coarse steps (0 means never)
+        pp.load("memory_checkpoint_interval", memory_checkpoint_interval, 0);
+
+        // on nans, roll back to one of the last nan_rollback_snapshots coarse
+        // steps (kept in memory), multiply dt by nan_rollback_dt_factor and
+        // sigma by nan_rollback_sigma_factor, optionally regrid and retry (at
+        // most nan_rollback_retries times in a row, 0 disables this)
+        pp.load("nan_rollback_retries", nan_rollback_retries, 0);
+        pp.load("nan_rollback_snapshots", nan_rollback_snapshots, 1);
+        pp.load("nan_rollback_dt_factor", nan_rollback_dt_factor, 0.5);
+        pp.load("nan_rollback_sigma_factor", nan_rollback_sigma_factor, 1.);
+        pp.load("nan_rollback_regrid", nan_rollback_regrid, false);
+
+        // split the boxes of the restart_file into boxes of at most this size
+        // on restart (0 keeps the boxes of the checkpoint)
+        pp.load("restart_max_box_size", restart_max_box_size, 0);
     }
 
     void read_filesystem_params(GRParmParse &pp)
@@ -133,11 +223,18 @@ class ChomboParameters
         // In this function, cannot use default value - it may print a 'default
         // message' to pout and a 'setPoutBaseName' must happen before
         restart_from_checkpoint = pp.contains("restart_file");
+        // start a new run from the data of a checkpoint at a different
+        // resolution (but with the same L)
+        warm_start = pp.contains("warm_start_file");
 #ifdef CH_USE_HDF5
         if (restart_from_checkpoint)
         {
             pp.load("restart_file", restart_file);
         }
+        if (warm_start)
+        {
+            pp.load("warm_start_file", warm_start_file);
+        }
         pp.load("chk_prefix", checkpoint_prefix);
         pp.load("plot_prefix", plot_prefix);
 #endif
@@ -371,13 +468,29 @@ class ChomboParameters
                 (num_ghosts <= block_factor),
             "must be >= 3 (4th order derivatives) or 4 (6th order derivatives) "
             "and <= min_box_size (aka block_factor)");
+        check_parameter("deep_halo_stages", deep_halo_stages,
+                        deep_halo_stages >= 1 && deep_halo_stages <= 4,
+                        "must be between 1 and 4 (the number of RK4 stages)");
+        if (deep_halo_stages > 1)
+        {
+            // the redundant RHS evaluation is not implemented for the
+            // boundary conditions
+            check_parameter("deep_halo_stages", deep_halo_stages,
+                            !boundary_params.nonperiodic_boundaries_exist,
+                            "must be 1 unless all boundaries are periodic");
+            check_parameter("deep_halo_stages", deep_halo_stages,
+                            deep_halo_stages * num_ghosts <= block_factor,
+                            "deep_halo_stages * num_ghosts must be <= "
+                            "min_box_size (aka block_factor)");
+        }
         check_parameter("tag_buffer_size", tag_buffer_size,
                         tag_buffer_size >= 0, "must be >= 0");
         // assume ref_ratio is always 2
         check_parameter(
             "grid_buffer_size", grid_buffer_size,
-            grid_buffer_size >= ceil(num_ghosts / 2.0),
-            "must be >= ceil(num_ghosts/max_ref_ratio) for proper nesting");
+            grid_buffer_size >= ceil(deep_halo_stages * num_ghosts / 2.0),
+            "must be >= ceil(deep_halo_stages * num_ghosts/max_ref_ratio) for "
+            "proper nesting");
 
         // check the restart_file exists and can be read if restarting from a
         // checkpoint
@@ -389,6 +502,22 @@ class ChomboParameters
             check_parameter("restart_file", restart_file, restart_file_exists,
                             "file cannot be opened for reading");
         }
+        if (warm_start)
+        {
+            bool warm_start_file_exists =
+                (access((hdf5_path + warm_start_file).c_str(), R_OK) == 0);
+            check_parameter("warm_start_file", warm_start_file,
+                            warm_start_file_exists,
+                            "file cannot be opened for reading");
+            check_parameter("warm_start_file", warm_start_file,
+                            !restart_from_checkpoint,
+                            "cannot be used with restart_file");
+        }
+        check_parameter("restart_max_box_size", restart_max_box_size,
+                        restart_max_box_size >= 0 &&
+                            restart_max_box_size % block_factor == 0,
+                        "must be >= 0 and a multiple of block_factor/"
+                        "min_box_size");
 #endif
 
         check_parameter("dt_multiplier", dt_multiplier, dt_multiplier > 0.0,
@@ -418,9 +547,62 @@ class ChomboParameters
                             (ivN[idir] + 1) % block_factor == 0,
                             invalid_message);
         }
+        if (autotune_box_size)
+        {
+            check_parameter("num_autotune_box_sizes", num_autotune_box_sizes,
+                            num_autotune_box_sizes > 0, "must be > 0");
+            for (int size : autotune_box_sizes)
+            {
+                check_parameter("autotune_box_sizes", size,
+                                size > 0 && size % block_factor == 0,
+                                "must be > 0 and multiples of "
+                                "block_factor/min_box_size = " +
+                                    std::to_string(block_factor));
+            }
+            check_parameter("autotune_num_trials", autotune_num_trials,
+                            autotune_num_trials > 0, "must be > 0");
+        }
+        check_parameter("agglomeration_boxes_per_rank",
+                        agglomeration_boxes_per_rank,
+                        agglomeration_boxes_per_rank >= 0, "must be >= 0");
+        check_parameter("regrid_max_uncovered_fraction",
+                        regrid_max_uncovered_fraction,
+                        regrid_max_uncovered_fraction >= 0.0 &&
+                            regrid_max_uncovered_fraction <= 1.0,
+                        "must be >= 0 and <= 1");
         check_parameter("fill_ratio", fill_ratio,
                         (fill_ratio > 0.0) && (fill_ratio <= 1.0),
                         "must be > 0 and <= 1");
+        check_parameter("small_data_flush_interval", small_data_flush_interval,
+                        small_data_flush_interval >= 0, "must be >= 0");
+        check_parameter("walltime_limit", walltime_limit,
+                        walltime_limit >= 0.0, "must be >= 0");
+        check_parameter("walltime_checkpoint_rate", walltime_checkpoint_rate,
+                        walltime_checkpoint_rate > 0.0, "must be > 0");
+        check_parameter("memory_checkpoint_interval",
+                        memory_checkpoint_interval,
+                        memory_checkpoint_interval >= 0, "must be >= 0");
+        check_parameter("dry_run_num_ranks", dry_run_num_ranks,
+                        dry_run_num_ranks >= 0, "must be >= 0");
+        check_parameter("nan_rollback_retries", nan_rollback_retries,
+                        nan_rollback_retries >= 0, "must be >= 0");
+        if (nan_rollback_retries > 0)
+        {
+            check_parameter("nan_rollback_snapshots", nan_rollback_snapshots,
+                            nan_rollback_snapshots >= 1, "must be >= 1");
+            check_parameter("nan_rollback_dt_factor", nan_rollback_dt_factor,
+                            nan_rollback_dt_factor > 0.0 &&
+                                nan_rollback_dt_factor <= 1.0,
+                            "must be > 0 and <= 1");
+            check_parameter("nan_rollback_sigma_factor",
+                            nan_rollback_sigma_factor,
+                            nan_rollback_sigma_factor >= 1.0, "must be >= 1");
+        }
+        check_parameter("walltime_safety_margin", walltime_safety_margin,
+                        walltime_safety_margin >= 0.0 &&
+                            (walltime_limit == 0.0 ||
+                             walltime_safety_margin < walltime_limit),
+                        "must be >= 0 and < walltime_limit");
         // (MR); while this would technically work (any plot files would just
         // overwrite a checkpoint file), I think a user would only ever do
         // this unintentinally
@@ -428,6 +610,29 @@ class ChomboParameters
         check_parameter("plot_prefix", plot_prefix,
                         plot_interval <= 0 || plot_prefix != checkpoint_prefix,
                         "should be different to checkpoint_prefix");
+        for (int ilevel = 0; ilevel <= max_level; ++ilevel)
+        {
+            const int factor = plot_coarsen_factors[ilevel];
+            const std::string name =
+                "plot_coarsen_factors[" + std::to_string(ilevel) + "]";
+            // the boxes of every level can be coarsened by block_factor
+            check_parameter(name, factor,
+                            factor >= 1 && block_factor % factor == 0,
+                            "must be >= 1 and divide block_factor/"
+                            "min_box_size");
+            check_parameter(name, factor, factor == 1 || !write_plot_ghosts,
+                            "must be 1 if write_plot_ghosts is set");
+            // the levels must still be properly nested in the plot file
+            if (ilevel > 0)
+            {
+                const int prev_factor = plot_coarsen_factors[ilevel - 1];
+                const int ratio = ref_ratios[ilevel - 1] * prev_factor;
+                check_parameter(name, factor,
+                                ratio % factor == 0 && ratio / factor >= 2,
+                                "must divide ref_ratio * plot_coarsen_factors"
+                                "[level - 1] at least twice");
+            }
+        }
 #endif
 
         check_parameter("output_path", output_path,
@@ -474,6 +679,8 @@ class ChomboParameters
                                       // derivatives - does nothing
                                       // in Chombo but can be used in examples
     int num_ghosts;         // min dependent on max_spatial_derivative_order
+    int deep_halo_stages;   // RK stages between ghost exchanges
+    bool cache_coarse_fine_ghosts; // reuse the interpolated ghosts
     int tag_buffer_size;    // Amount the tagged region is grown by
     int grid_buffer_size;   // Number of cells between level
     Vector<int> ref_ratios; // ref ratios between levels
@@ -481,14 +688,25 @@ class ChomboParameters
     Vector<int> regrid_interval; // steps between regrid at each level
     int max_steps;
     bool restart_from_checkpoint; // whether or not to restart or start afresh
+    bool warm_start; // whether the initial data comes from warm_start_file
+    int restart_max_box_size; // split the restart_file's boxes (if > 0)
 #ifdef CH_USE_HDF5
     std::string restart_file;             // The path to the restart_file
+    std::string warm_start_file; // t = 0 checkpoint to take the data from
     bool ignore_checkpoint_name_mismatch; // ignore mismatch of variable names
                                           // between restart file and program
 #endif
     double dt_multiplier, stop_time;        // The Courant factor and stop time
     int checkpoint_interval, plot_interval; // Steps between outputs
     int max_grid_size, block_factor;        // max and min box sizes
+    bool use_huge_pages;                    // huge pages for FArrayBox data
+    int agglomeration_boxes_per_rank;       // min boxes per rank on a level
+    double regrid_max_uncovered_fraction; // to interpolate only newly refined
+                                          // regions on regrids
+    bool autotune_box_size; // time candidate max box sizes at the start
+    int num_autotune_box_sizes, autotune_num_trials;
+    std::vector<int> autotune_box_sizes; // the candidate max box sizes
+    bool autotune_apply; // use the fastest rather than just recommending it
     double fill_ratio; // determines how fussy the regridding is about tags
 #ifdef CH_USE_HDF5
     std::string checkpoint_prefix, plot_prefix; // naming of files
@@ -501,6 +719,8 @@ class ChomboParameters
 #ifdef CH_USE_HDF5
     std::string hdf5_path; // base path for pout files
     bool write_plot_ghosts;
+    std::vector<int> plot_coarsen_factors; // per level plot file coarsening
+    bool plot_coarsen_average; // average (rather than subsample) the cells
     int num_plot_vars;
     std::vector<std::pair<int, VariableType>>
         plot_vars; // vars to write to plot file
@@ -518,7 +738,20 @@ class ChomboParameters
     // For checking parameters and then exiting rather before instantiating
     // GRAMR (or child) object
     bool just_check_params = false;
+    bool dry_run;          // estimate the cost of the run and stop
+    int dry_run_num_ranks; // the ranks to estimate for (0 = the current)
     bool print_progress_only_to_rank_0;
+    bool async_diagnostics;  // integrate/write diagnostics in background
+    int small_data_flush_interval; // coarse steps between small data writes
+    bool write_regrid_stats; // write regrid timings and grid churn
+    double walltime_limit, walltime_safety_margin; // in hours
+    double walltime_checkpoint_rate;               // in MB/s
+    bool checkpoint_on_signal; // checkpoint and stop on SIGUSR1/SIGTERM
+    int memory_checkpoint_interval; // coarse steps between memory checkpoints
+    int nan_rollback_retries;       // max consecutive nan rollbacks
+    int nan_rollback_snapshots;     // coarse steps kept to roll back to
+    double nan_rollback_dt_factor, nan_rollback_sigma_factor;
+    bool nan_rollback_regrid; // whether to regrid after a nan rollback
 
   protected:
     // the low and high corners of the domain taking into account reflective BCs
@@ -0,0 +1,123 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+// Chombo includes
+#include "IntVectSet.H"
+#include "ProblemDomain.H"
+
+// Our includes
+#include "CoarseFineGhostCache.hpp"
+
+// Other includes
+#include <cmath>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+bool CoarseFineGhostCache::fill(LevelData<FArrayBox> &a_soln, double a_alpha)
+{
+    CH_TIME("CoarseFineGhostCache::fill");
+    define_regions(a_soln);
+
+    for (const entry_t &entry : m_entries)
+    {
+        if (std::abs(entry.alpha - a_alpha) > 1e-12)
+            continue;
+
+        DataIterator dit = a_soln.dataIterator();
+        const int nbox = dit.size();
+#pragma omp parallel for default(shared)
+        for (int ibox = 0; ibox < nbox; ++ibox)
+        {
+            const DataIndex &di = dit[ibox];
+            const Vector<Box> &regions = m_regions[di];
+            Real *values = const_cast<Real *>(entry.values[ibox].data());
+            for (int iregion = 0; iregion < regions.size(); ++iregion)
+            {
+                const Box &region = regions[iregion];
+                const FArrayBox stored(region, m_num_comps, values);
+                a_soln[di].copy(stored, region);
+                values += region.numPts() * m_num_comps;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+void CoarseFineGhostCache::store(const LevelData<FArrayBox> &a_soln,
+                                 double a_alpha)
+{
+    CH_TIME("CoarseFineGhostCache::store");
+    define_regions(a_soln);
+
+    DataIterator dit = a_soln.dataIterator();
+    const int nbox = dit.size();
+    m_entries.push_back({a_alpha, std::vector<std::vector<Real>>(nbox)});
+    entry_t &entry = m_entries.back();
+#pragma omp parallel for default(shared)
+    for (int ibox = 0; ibox < nbox; ++ibox)
+    {
+        const DataIndex &di = dit[ibox];
+        const Vector<Box> &regions = m_regions[di];
+        long long num_values = 0;
+        for (int iregion = 0; iregion < regions.size(); ++iregion)
+            num_values += regions[iregion].numPts() * m_num_comps;
+        entry.values[ibox].resize(num_values);
+
+        Real *values = entry.values[ibox].data();
+        for (int iregion = 0; iregion < regions.size(); ++iregion)
+        {
+            const Box &region = regions[iregion];
+            FArrayBox stored(region, m_num_comps, values);
+            stored.copy(a_soln[di], region);
+            values += region.numPts() * m_num_comps;
+        }
+    }
+}
+
+void CoarseFineGhostCache::define_regions(const LevelData<FArrayBox> &a_soln)
+{
+    const DisjointBoxLayout &grids = a_soln.disjointBoxLayout();
+    if (grids == m_grids && a_soln.nComp() == m_num_comps &&
+        a_soln.ghostVect() == m_ghost_vect)
+        return;
+
+    m_entries.clear();
+    m_grids = grids;
+    m_num_comps = a_soln.nComp();
+    m_ghost_vect = a_soln.ghostVect();
+    m_regions.define(grids);
+
+    // The coarse-fine ghosts are those in the domain (allowing for
+    // periodicity) not covered by any box on this level (or its periodic
+    // images)
+    const ProblemDomain &domain = grids.physDomain();
+    const IntVect domain_size = domain.domainBox().size();
+    DataIterator dit = grids.dataIterator();
+    for (dit.begin(); dit.ok(); ++dit)
+    {
+        Box ghosted_box = grow(grids[dit], m_ghost_vect);
+        ghosted_box &= domain;
+        IntVectSet cf_ghosts(ghosted_box);
+
+        LayoutIterator lit = grids.layoutIterator();
+        for (lit.begin(); lit.ok(); ++lit)
+        {
+            const Box &other_box = grids[lit];
+            if (other_box.intersectsNotEmpty(ghosted_box))
+                cf_ghosts -= other_box;
+            ShiftIterator shift_it = domain.shiftIterator();
+            for (shift_it.begin(); shift_it.ok(); ++shift_it)
+            {
+                const Box shifted_box =
+                    shift(other_box, domain_size * shift_it());
+                if (shifted_box.intersectsNotEmpty(ghosted_box))
+                    cf_ghosts -= shifted_box;
+            }
+        }
+        m_regions[dit] = cf_ghosts.boxes();
+    }
+}
@@ -0,0 +1,73 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef COARSEFINEGHOSTCACHE_HPP_
+#define COARSEFINEGHOSTCACHE_HPP_
+
+// Chombo includes
+#include "DisjointBoxLayout.H"
+#include "FArrayBox.H"
+#include "LayoutData.H"
+#include "LevelData.H"
+
+// Other includes
+#include <vector>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+/// Stores the coarse-fine ghost values of a level for each time interpolation
+/// coefficient used during the current coarse step
+/**
+ * The ghosts at the coarse-fine boundary of a fine level are interpolated in
+ * space from the coarse level's time interpolant at every RK stage. Only a
+ * few distinct interpolation coefficients occur in a coarse step (e.g. 0,
+ * 1/4, 1/2, 3/4 and 1 for RK4 with a refinement ratio of 2) and the result
+ * only depends on the coefficient and the fine grids, so this stores the
+ * values the first time each coefficient is used and copies them back for
+ * later stages and substeps. It must be cleared whenever the coarse time
+ * interpolant changes (i.e. when the coarser level advances).
+ *
+ * The memory used is one copy of the coarse-fine ghost shell (all the
+ * components of the ghosts of the LevelData, i.e. deep_halo_stages *
+ * num_ghosts cells deep, not covered by other boxes) per coefficient. As
+ * GRAMRLevel only allows the 5 coefficients above this is at most 5 shells,
+ * which for a small fine level can be comparable to its valid data, so
+ * GRAMRLevel only uses the cache if cache_coarse_fine_ghosts is set.
+ */
+class CoarseFineGhostCache
+{
+  public:
+    CoarseFineGhostCache() {}
+
+    //! Discard all stored values
+    void clear() { m_entries.clear(); }
+
+    //! Copy the stored ghost values for a_alpha into a_soln, returning false
+    //! (and leaving a_soln unchanged) if there are none
+    bool fill(LevelData<FArrayBox> &a_soln, double a_alpha);
+
+    //! Store the coarse-fine ghost values of a_soln for a_alpha
+    void store(const LevelData<FArrayBox> &a_soln, double a_alpha);
+
+  protected:
+    struct entry_t
+    {
+        double alpha;
+        //! the ghost values of each local box (in DataIterator order)
+        std::vector<std::vector<Real>> values;
+    };
+
+    DisjointBoxLayout m_grids;   //!< the grids the regions were worked out on
+    int m_num_comps = 0;         //!< the number of components stored
+    IntVect m_ghost_vect;        //!< the ghosts the regions were worked out for
+    LayoutData<Vector<Box>> m_regions; //!< the coarse-fine ghosts of each box
+    std::vector<entry_t> m_entries;
+
+    //! (Re)compute the coarse-fine ghost regions if the grids have changed
+    void define_regions(const LevelData<FArrayBox> &a_soln);
+};
+
+#endif /* COARSEFINEGHOSTCACHE_HPP_ */
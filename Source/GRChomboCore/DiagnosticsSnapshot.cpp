@@ -0,0 +1,75 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+// Chombo includes
+#include "CH_Timer.H"
+#include "MayDay.H"
+#include "computeNorm.H"
+
+// Our includes
+#include "DiagnosticsSnapshot.hpp"
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+void DiagnosticsSnapshot::add_level(int a_level,
+                                    const LevelData<FArrayBox> &a_state,
+                                    double a_dx, int a_ref_ratio,
+                                    int a_num_diagnostic_vars)
+{
+    CH_TIME("DiagnosticsSnapshot::add_level");
+
+    if (a_level >= static_cast<int>(m_levels.size()))
+        m_levels.resize(a_level + 1);
+    level_t &level = m_levels[a_level];
+    if (level.state != nullptr)
+        MayDay::Error("DiagnosticsSnapshot::add_level: level already added");
+
+    const DisjointBoxLayout &grids = a_state.disjointBoxLayout();
+    level.state.reset(new LevelData<FArrayBox>(grids, a_state.nComp(),
+                                               a_state.ghostVect()));
+    level.diagnostics.reset(
+        new LevelData<FArrayBox>(grids, a_num_diagnostic_vars));
+    level.dx = a_dx;
+    level.ref_ratio = a_ref_ratio;
+
+    // a local copy (with the ghosts) needs no communication
+    for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+        FArrayBox &state_box = (*level.state)[dit];
+        FArrayBox &diagnostics_box = (*level.diagnostics)[dit];
+        state_box.copy(a_state[dit]);
+        diagnostics_box.setVal(0.);
+        m_boxes.push_back({&state_box, &diagnostics_box, grids[dit], a_dx});
+    }
+}
+
+bool DiagnosticsSnapshot::has_levels(int a_finest_level) const
+{
+    if (static_cast<int>(m_levels.size()) != a_finest_level + 1)
+        return false;
+    for (const level_t &level : m_levels)
+    {
+        if (level.state == nullptr)
+            return false;
+    }
+    return true;
+}
+
+Real DiagnosticsSnapshot::norm(const Interval &a_vars,
+                               int a_norm_exponent) const
+{
+    CH_TIME("DiagnosticsSnapshot::norm");
+
+    Vector<LevelData<FArrayBox> *> diagnostics(m_levels.size());
+    Vector<int> ref_ratios(m_levels.size());
+    for (int ilevel = 0; ilevel < m_levels.size(); ++ilevel)
+    {
+        diagnostics[ilevel] = m_levels[ilevel].diagnostics.get();
+        ref_ratios[ilevel] = m_levels[ilevel].ref_ratio;
+    }
+    return computeNorm(diagnostics, ref_ratios, m_levels[0].dx, a_vars,
+                       a_norm_exponent);
+}
@@ -0,0 +1,72 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef DIAGNOSTICSSNAPSHOT_HPP_
+#define DIAGNOSTICSSNAPSHOT_HPP_
+
+// Chombo includes
+#include "FArrayBox.H"
+#include "Interval.H"
+#include "LevelData.H"
+
+// Other includes
+#include <memory>
+#include <vector>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+/// A copy of the evolution variables of the levels of the hierarchy
+/// (including their ghosts) on which diagnostics can be computed in the
+/// background while the evolution continues
+/**
+ * The levels are copied on the main thread once their ghosts have been
+ * filled. Each box is also listed with raw pointers to its data so that a
+ * task on the AsyncTaskQueue can loop over them without touching any of
+ * Chombo's reference counted layouts (which are not thread safe). The
+ * diagnostic variables computed in the boxes are then reduced over the
+ * hierarchy with norm() on the main thread. The snapshot must also be
+ * destroyed on the main thread.
+ */
+class DiagnosticsSnapshot
+{
+  public:
+    //! A box of a level and the data to compute the diagnostics in it from
+    struct box_t
+    {
+        const FArrayBox *state; //!< the evolution variables (with ghosts)
+        FArrayBox *diagnostics; //!< the diagnostic variables (no ghosts)
+        Box valid_box;
+        double dx;
+    };
+
+    //! Copies a_state (with its ghosts) as level a_level (the levels may be
+    //! added in any order)
+    void add_level(int a_level, const LevelData<FArrayBox> &a_state,
+                   double a_dx, int a_ref_ratio, int a_num_diagnostic_vars);
+
+    //! Whether levels 0 to a_finest_level (and no others) have been added
+    bool has_levels(int a_finest_level) const;
+
+    //! The boxes of all the levels (fixed once the levels have been added)
+    const std::vector<box_t> &boxes() const { return m_boxes; }
+
+    //! The volume weighted p-norm of the diagnostic variables a_vars over
+    //! the cells not covered by a finer level (collective)
+    Real norm(const Interval &a_vars, int a_norm_exponent = 2) const;
+
+  private:
+    struct level_t
+    {
+        std::unique_ptr<LevelData<FArrayBox>> state;
+        std::unique_ptr<LevelData<FArrayBox>> diagnostics;
+        double dx = 0.;
+        int ref_ratio = 0;
+    };
+    std::vector<level_t> m_levels;
+    std::vector<box_t> m_boxes;
+};
+
+#endif /* DIAGNOSTICSSNAPSHOT_HPP_ */
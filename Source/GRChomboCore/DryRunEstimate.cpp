@@ -0,0 +1,108 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+// Chombo includes
+#include "parstream.H"
+
+// Our includes
+#include "DryRunEstimate.hpp"
+
+// Other includes
+#include <algorithm>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+const std::array<std::string, DryRunEstimate::NUM_MEMORY_TYPES>
+    DryRunEstimate::s_memory_names = {"state", "old_state", "rk_stages",
+                                      "diagnostics", "interpolation"};
+
+void DryRunEstimate::print(const std::vector<level_t> &a_levels,
+                           int a_num_ranks, bool a_per_rank)
+{
+    const double MiB = 1024. * 1024.;
+    std::vector<long long> total_rank_bytes(a_num_ranks, 0);
+    std::vector<long long> total_rank_comm_bytes(a_num_ranks, 0);
+    double step_time = 0.;
+    bool step_time_known = true;
+
+    pout() << "DryRunEstimate: estimates for " << a_num_ranks << " ranks"
+           << endl;
+    for (int ilevel = 0; ilevel < a_levels.size(); ++ilevel)
+    {
+        const level_t &level = a_levels[ilevel];
+
+        // the most loaded rank determines the time of each step
+        const long long max_rank_cells =
+            *std::max_element(level.rank_cells.begin(), level.rank_cells.end());
+        std::array<long long, NUM_MEMORY_TYPES> max_rank_bytes;
+        max_rank_bytes.fill(0);
+        long long max_rank_comm_bytes = 0;
+        for (int irank = 0; irank < a_num_ranks; ++irank)
+        {
+            long long rank_bytes = 0;
+            for (int itype = 0; itype < NUM_MEMORY_TYPES; ++itype)
+            {
+                max_rank_bytes[itype] = std::max(
+                    max_rank_bytes[itype], level.rank_bytes[irank][itype]);
+                rank_bytes += level.rank_bytes[irank][itype];
+            }
+            total_rank_bytes[irank] += rank_bytes;
+            total_rank_comm_bytes[irank] += level.exchanges_per_step *
+                                            level.substeps *
+                                            level.rank_comm_bytes[irank];
+            max_rank_comm_bytes =
+                std::max(max_rank_comm_bytes, level.rank_comm_bytes[irank]);
+        }
+
+        pout() << "Level " << ilevel << ": " << level.num_boxes << " boxes, "
+               << level.num_cells << " cells (ghost overhead "
+               << 100. * level.num_ghost_cells / level.num_cells
+               << "%), max/mean cells per rank " << max_rank_cells << "/"
+               << level.num_cells / a_num_ranks << ", " << level.substeps
+               << " steps per coarse step" << endl;
+        pout() << "    max memory per rank (MiB):";
+        for (int itype = 0; itype < NUM_MEMORY_TYPES; ++itype)
+        {
+            pout() << " " << s_memory_names[itype] << " "
+                   << max_rank_bytes[itype] / MiB;
+        }
+        pout() << endl;
+        pout() << "    max ghost exchange per rank (MiB): "
+               << max_rank_comm_bytes / MiB << " (" << level.exchanges_per_step
+               << " per step)" << endl;
+
+        if (level.cell_time > 0.)
+            step_time += 4 * level.substeps * level.cell_time * max_rank_cells;
+        else
+            step_time_known = false;
+    }
+
+    const auto max_bytes_it =
+        std::max_element(total_rank_bytes.begin(), total_rank_bytes.end());
+    pout() << "Peak memory per rank (MiB): " << *max_bytes_it / MiB
+           << " on rank " << max_bytes_it - total_rank_bytes.begin() << endl;
+    pout() << "Max ghost exchange per rank per coarse step (MiB): "
+           << *std::max_element(total_rank_comm_bytes.begin(),
+                                total_rank_comm_bytes.end()) /
+                  MiB
+           << endl;
+    if (step_time_known)
+    {
+        pout() << "Time per coarse step (s, from the measured cost per cell): "
+               << step_time << endl;
+    }
+
+    if (a_per_rank)
+    {
+        pout() << "rank memory(MiB) ghost_exchange_per_coarse_step(MiB)"
+               << endl;
+        for (int irank = 0; irank < a_num_ranks; ++irank)
+        {
+            pout() << irank << " " << total_rank_bytes[irank] / MiB << " "
+                   << total_rank_comm_bytes[irank] / MiB << endl;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef DRYRUNESTIMATE_HPP_
+#define DRYRUNESTIMATE_HPP_
+
+// Other includes
+#include <array>
+#include <string>
+#include <vector>
+
+/// Estimates of the cost of a run on a given number of ranks made from the
+/// initial hierarchy (see GRAMR::dry_run)
+/**
+ * Each level fills a level_t from its grids balanced over the requested
+ * number of ranks and print() sums them up. All numbers are the same on
+ * every rank.
+ */
+class DryRunEstimate
+{
+  public:
+    //! What the memory of a level is used for
+    enum Memory
+    {
+        STATE,         //!< the current state (with ghosts)
+        OLD_STATE,     //!< the state at the start of the step (with ghosts)
+        RK_STAGES,     //!< the stage solution and RHS of the RK4 advance
+        DIAGNOSTICS,   //!< the diagnostic variables (with ghosts)
+        INTERPOLATION, //!< the time interpolator for the coarse-fine ghosts
+        NUM_MEMORY_TYPES
+    };
+
+    struct level_t
+    {
+        int num_boxes = 0;
+        long long num_cells = 0;       //!< valid cells
+        long long num_ghost_cells = 0; //!< ghosts of the state of all boxes
+        int substeps = 1;              //!< steps per coarse step
+        int exchanges_per_step = 4;    //!< ghost exchanges per step
+        double cell_time = 0.; //!< measured seconds per cell for a ghost
+                               //!< fill and RHS evaluation (0 if unknown)
+        std::vector<long long> rank_cells; //!< valid cells on each rank
+        //! bytes of each type of memory on each rank
+        std::vector<std::array<long long, NUM_MEMORY_TYPES>> rank_bytes;
+        //! bytes each rank receives in an exchange of the state ghosts
+        std::vector<long long> rank_comm_bytes;
+    };
+
+    //! Prints the estimates for each level and for the whole run to pout()
+    //! (and the totals of every rank if a_per_rank)
+    static void print(const std::vector<level_t> &a_levels, int a_num_ranks,
+                      bool a_per_rank);
+
+    static const std::array<std::string, NUM_MEMORY_TYPES> s_memory_names;
+};
+
+#endif /* DRYRUNESTIMATE_HPP_ */
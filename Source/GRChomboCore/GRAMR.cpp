@@ -5,15 +5,261 @@
 
 #include "GRAMR.hpp"
 #include "GRAMRLevel.hpp"
+#include "SmallDataIOBuffer.hpp"
+#include <cmath>
 
 GRAMR::GRAMR() : m_interpolator(nullptr) {}
 
+void GRAMR::run(Real a_max_time, int a_max_step)
+{
+    const bool nan_rollback = (m_nan_rollback_max_retries > 0);
+    if (!m_walltime_monitor.is_active() && m_memory_checkpoint_interval <= 0 &&
+        !nan_rollback)
+    {
+        AMR::run(a_max_time, a_max_step);
+        finish_diagnostics();
+        return;
+    }
+
+    if (m_memory_checkpoint_interval > 0)
+        write_memory_checkpoint();
+    if (nan_rollback)
+        take_nan_snapshot();
+    // the number of rollbacks since the run last got past the step at which
+    // nans were found
+    int num_retries = 0;
+    int nan_step = 0;
+    m_walltime_monitor.start(get_walltime());
+    while (m_cur_step < a_max_step)
+    {
+        const int step = m_cur_step;
+        AMR::run(a_max_time, step + 1);
+        // no step is taken once a_max_time is reached
+        if (m_cur_step == step)
+            break;
+
+        if (nan_rollback)
+        {
+            // the diagnostics of the step are part of its output (held back
+            // until it is accepted)
+            finish_diagnostics();
+            if (hierarchy_has_nans())
+            {
+                if (num_retries == m_nan_rollback_max_retries)
+                {
+                    pout() << "GRAMR::run: nans at step " << m_cur_step
+                           << " after " << num_retries << " rollbacks"
+                           << endl;
+                    MayDay::Error("GRAMR::run: nans persist after the maximum "
+                                  "number of rollbacks");
+                }
+                ++num_retries;
+                nan_step = std::max(nan_step, m_cur_step);
+                pout() << "GRAMR::run: nans at step " << m_cur_step
+                       << " (time " << m_cur_time << "), rollback "
+                       << num_retries << " of " << m_nan_rollback_max_retries
+                       << endl;
+                nan_rollback(num_retries);
+                continue;
+            }
+            if (m_cur_step >= nan_step)
+                num_retries = 0;
+            // the output held back during the step can now be written
+            SmallDataIOBuffer::step_accepted();
+            take_nan_snapshot();
+        }
+
+        if (m_memory_checkpoint_interval > 0 &&
+            m_cur_step % m_memory_checkpoint_interval == 0)
+        {
+            write_memory_checkpoint();
+        }
+
+        const double walltime = get_walltime();
+        m_walltime_monitor.step_finished(walltime, checkpoint_bytes());
+        if (m_cur_step < a_max_step &&
+            m_walltime_monitor.should_stop(walltime))
+        {
+            pout() << "GRAMR::run: stopping at step " << m_cur_step
+                   << " after " << walltime << " hours ("
+                   << (WalltimeMonitor::signal_received()
+                           ? "signal received"
+                           : "walltime limit approaching")
+                   << ")" << endl;
+#ifdef CH_USE_HDF5
+            writeCheckpointFile();
+#endif
+            break;
+        }
+    }
+    finish_diagnostics();
+}
+
 // Called after AMR object set up
 void GRAMR::set_interpolator(AMRInterpolator<Lagrange<4>> *a_interpolator)
 {
     m_interpolator = a_interpolator;
 }
 
+void GRAMR::write_memory_checkpoint()
+{
+    CH_TIME("GRAMR::write_memory_checkpoint");
+
+    fill_memory_checkpoint(m_memory_checkpoint);
+    m_memory_checkpoint.exchange_with_buddy();
+
+    if (m_verbosity)
+    {
+        pout() << "GRAMR::write_memory_checkpoint: step " << m_cur_step
+               << " using " << m_memory_checkpoint.num_bytes() << " bytes"
+               << endl;
+    }
+}
+
+void GRAMR::read_memory_checkpoint(bool a_from_buddy)
+{
+    CH_TIME("GRAMR::read_memory_checkpoint");
+
+    if (!m_memory_checkpoint.is_valid())
+        MayDay::Error("GRAMR::read_memory_checkpoint: no checkpoint stored");
+
+    if (a_from_buddy)
+        m_memory_checkpoint.recover_from_buddy();
+    restore_memory_checkpoint(m_memory_checkpoint);
+
+    pout() << "GRAMR::read_memory_checkpoint: restored step " << m_cur_step
+           << " at time " << m_cur_time << endl;
+}
+
+void GRAMR::fill_memory_checkpoint(MemoryCheckpoint &a_checkpoint) const
+{
+    a_checkpoint.step = m_cur_step;
+    a_checkpoint.time = m_cur_time;
+    a_checkpoint.dt_base = m_dt_base;
+    a_checkpoint.finest_level = m_finest_level;
+    a_checkpoint.levels.resize(m_finest_level + 1);
+    for (int level_idx = 0; level_idx <= m_finest_level; ++level_idx)
+    {
+        const GRAMRLevel &level = *GRAMRLevel::gr_cast(m_amrlevels[level_idx]);
+        level.writeMemoryCheckpointLevel(a_checkpoint.levels[level_idx]);
+    }
+    a_checkpoint.extra_data.clear();
+    specific_write_memory_checkpoint(a_checkpoint.extra_data);
+}
+
+void GRAMR::restore_memory_checkpoint(const MemoryCheckpoint &a_checkpoint)
+{
+    // restore from coarse to fine (so that any regrids can interpolate from
+    // the restored coarser level) and remove any finer levels
+    const int finest_level =
+        std::max(m_finest_level, a_checkpoint.finest_level);
+    for (int level_idx = 0; level_idx <= finest_level; ++level_idx)
+    {
+        GRAMRLevel &level = *GRAMRLevel::gr_cast(m_amrlevels[level_idx]);
+        if (level_idx <= a_checkpoint.finest_level)
+            level.readMemoryCheckpointLevel(a_checkpoint.levels[level_idx]);
+        else
+            m_amrlevels[level_idx]->regrid(Vector<Box>());
+    }
+
+    m_finest_level = a_checkpoint.finest_level;
+    m_cur_step = a_checkpoint.step;
+    m_cur_time = a_checkpoint.time;
+    // the levels have scaled their dt by any change in dt_multiplier
+    m_dt_base = a_checkpoint.dt_base * m_amrlevels[0]->dt() /
+                a_checkpoint.levels[0].dt;
+    specific_read_memory_checkpoint(a_checkpoint.extra_data);
+}
+
+void GRAMR::take_nan_snapshot()
+{
+    CH_TIME("GRAMR::take_nan_snapshot");
+
+    // reuse the oldest snapshot's memory
+    if (m_nan_snapshots.size() < m_nan_rollback_num_snapshots)
+        m_nan_snapshots.emplace_back();
+    else
+    {
+        m_nan_snapshots.push_back(std::move(m_nan_snapshots.front()));
+        m_nan_snapshots.pop_front();
+    }
+    fill_memory_checkpoint(m_nan_snapshots.back());
+
+    // any output of the step (including diagnostics still queued) is kept
+    finish_diagnostics();
+    m_nan_snapshots.back().small_data_sizes =
+        SmallDataIOBuffer::get_output_sizes();
+}
+
+double GRAMR::checkpoint_bytes() const
+{
+    // the boxes of each level are known on every rank
+    double num_cells = 0.;
+    for (int level_idx = 0; level_idx <= m_finest_level; ++level_idx)
+    {
+        const Vector<Box> &boxes = m_amrlevels[level_idx]->boxes();
+        for (int ibox = 0; ibox < boxes.size(); ++ibox)
+            num_cells += boxes[ibox].numPts();
+    }
+    return num_cells * NUM_VARS * sizeof(Real);
+}
+
+bool GRAMR::hierarchy_has_nans() const
+{
+    CH_TIME("GRAMR::hierarchy_has_nans");
+
+    int has_nans = 0;
+    for (int level_idx = 0; level_idx <= m_finest_level && !has_nans;
+         ++level_idx)
+    {
+        const GRAMRLevel &level = *GRAMRLevel::gr_cast(m_amrlevels[level_idx]);
+        has_nans = level.hasNaNs();
+    }
+#ifdef CH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &has_nans, 1, MPI_INT, MPI_MAX,
+                  Chombo_MPI::comm);
+#endif
+    return has_nans;
+}
+
+void GRAMR::nan_rollback(int a_retry)
+{
+    CH_TIME("GRAMR::nan_rollback");
+
+    // Reduce dt_multiplier (and hence dt) and increase sigma once more on
+    // every retry, so that they keep shrinking (growing) across consecutive
+    // retries. This includes the levels above m_finest_level so that they
+    // use the same parameters if they are created later.
+    for (int level_idx = 0; level_idx < m_amrlevels.size(); ++level_idx)
+    {
+        GRAMRLevel &level = *GRAMRLevel::gr_cast(m_amrlevels[level_idx]);
+        level.applyNaNRemedy(m_nan_rollback_dt_factor,
+                             m_nan_rollback_sigma_factor);
+    }
+
+    // the first retry restarts from the latest snapshot, each further one
+    // from the one before (as long as there is one)
+    if (a_retry > 1 && m_nan_snapshots.size() > 1)
+        m_nan_snapshots.pop_back();
+    const MemoryCheckpoint &snapshot = m_nan_snapshots.back();
+
+    // remove the output of the discarded steps (including any diagnostics
+    // still queued) from the small data files
+    finish_diagnostics();
+    SmallDataIOBuffer::discard_output(snapshot.small_data_sizes);
+
+    // this scales each level's dt by the change in dt_multiplier since the
+    // snapshot was taken
+    restore_memory_checkpoint(snapshot);
+
+    if (m_nan_rollback_regrid)
+        regrid(0);
+
+    pout() << "GRAMR::nan_rollback: restarting from step " << m_cur_step
+           << " (time " << m_cur_time << ") with dt = " << m_dt_base
+           << (m_nan_rollback_regrid ? " after a regrid" : "") << endl;
+}
+
 // returs a std::vector of GRAMRLevel pointers
 // similar to AMR::getAMRLevels()
 std::vector<GRAMRLevel *> GRAMR::get_gramrlevels()
@@ -40,6 +286,147 @@ std::vector<const GRAMRLevel *> GRAMR::get_gramrlevels() const
     return out;
 }
 
+int GRAMR::autotune_box_size(const std::vector<int> &a_box_sizes,
+                             int a_num_trials)
+{
+    CH_TIME("GRAMR::autotune_box_size");
+
+    // the time per coarsest level step for each box size
+    std::vector<double> total_times(a_box_sizes.size(), 0.);
+    double num_substeps = 1.;
+    for (int level_idx = 0; level_idx <= m_finest_level; ++level_idx)
+    {
+        GRAMRLevel &level = *GRAMRLevel::gr_cast(m_amrlevels[level_idx]);
+        if (level_idx > 0)
+            num_substeps *= m_amrlevels[level_idx - 1]->refRatio();
+
+        int best_size_idx = 0;
+        std::vector<double> level_times(a_box_sizes.size());
+        for (int size_idx = 0; size_idx < a_box_sizes.size(); ++size_idx)
+        {
+            level_times[size_idx] =
+                level.timeBoxSizeTrial(a_box_sizes[size_idx], a_num_trials);
+            total_times[size_idx] += num_substeps * level_times[size_idx];
+            if (level_times[size_idx] < level_times[best_size_idx])
+                best_size_idx = size_idx;
+        }
+        pout() << "GRAMR::autotune_box_size: fastest max_box_size on level "
+               << level_idx << " is " << a_box_sizes[best_size_idx] << " ("
+               << level_times[best_size_idx] << "s per RHS evaluation)"
+               << endl;
+    }
+
+    const int best_size_idx =
+        std::min_element(total_times.begin(), total_times.end()) -
+        total_times.begin();
+    pout() << "GRAMR::autotune_box_size: recommended max_box_size = "
+           << a_box_sizes[best_size_idx] << " (" << total_times[best_size_idx]
+           << "s of RHS evaluations per coarsest step, against";
+    for (int size_idx = 0; size_idx < a_box_sizes.size(); ++size_idx)
+    {
+        if (size_idx != best_size_idx)
+            pout() << " " << total_times[size_idx] << "s for "
+                   << a_box_sizes[size_idx];
+    }
+    pout() << ")" << endl;
+
+    return a_box_sizes[best_size_idx];
+}
+
+void GRAMR::apply_max_box_size(int a_max_box_size)
+{
+    CH_TIME("GRAMR::apply_max_box_size");
+
+    maxGridSize(a_max_box_size);
+
+    // Regrid from coarse to fine so that each level redefines its coarse-fine
+    // operators on the new grids of the coarser level. The region each level
+    // covers is unchanged so all the data (including the boundary ghosts) is
+    // kept rather than interpolated
+    for (int level_idx = 0; level_idx <= m_finest_level; ++level_idx)
+    {
+        GRAMRLevel &level = *GRAMRLevel::gr_cast(m_amrlevels[level_idx]);
+        level.resplitGrids(a_max_box_size);
+    }
+    // this is not a regrid to report in the regrid stats
+    m_regrid_profiler.reset();
+}
+
+void GRAMR::dry_run(int a_num_ranks)
+{
+    CH_TIME("GRAMR::dry_run");
+
+    const int num_ranks = (a_num_ranks > 0) ? a_num_ranks : numProc();
+    const Real coarsest_dt = m_amrlevels[0]->dt();
+    std::vector<DryRunEstimate::level_t> estimates;
+    for (int level_idx = 0; level_idx <= m_finest_level; ++level_idx)
+    {
+        GRAMRLevel &level = *GRAMRLevel::gr_cast(m_amrlevels[level_idx]);
+        estimates.push_back(level.estimateDryRun(num_ranks, true));
+        estimates.back().substeps = std::round(coarsest_dt / level.dt());
+    }
+    DryRunEstimate::print(estimates, num_ranks, m_verbosity > 0);
+}
+
+void GRAMR::run_in_situ_analyses(bool a_at_plot)
+{
+    // AMR::run only increments m_cur_step after the coarse step
+    const int step = a_at_plot ? m_cur_step : m_cur_step + 1;
+    std::vector<const InSituAnalysis *> due_analyses;
+    for (in_situ_analysis_t &entry : m_in_situ_analyses)
+    {
+        // the plot files are written after the end of the step so skip the
+        // analyses which have just been called for it
+        const bool due =
+            a_at_plot
+                ? (entry.at_plot && entry.last_interval_step != step)
+                : (entry.interval > 0 && step % entry.interval == 0);
+        if (due)
+            due_analyses.push_back(&entry.analysis);
+        if (due && !a_at_plot)
+            entry.last_interval_step = step;
+    }
+    if (due_analyses.empty())
+        return;
+
+    CH_TIME("GRAMR::run_in_situ_analyses");
+    InSituData data;
+    data.time = m_amrlevels[0]->time();
+    data.dt = m_amrlevels[0]->dt();
+    data.step = step;
+    data.at_plot = a_at_plot;
+    for (int level_idx = 0; level_idx <= m_finest_level; ++level_idx)
+    {
+        const GRAMRLevel &level = *GRAMRLevel::gr_cast(m_amrlevels[level_idx]);
+        const GRLevelData &state = level.getLevelData();
+        data.levels.push_back(
+            {level_idx, level.get_dx(), level.refRatio(),
+             &state.disjointBoxLayout(), &state,
+             (NUM_DIAGNOSTIC_VARS > 0)
+                 ? &level.getLevelData(VariableType::diagnostic)
+                 : nullptr});
+    }
+
+    for (const InSituAnalysis *analysis : due_analyses)
+        (*analysis)(data);
+}
+
+void GRAMR::run_deferred_diagnostics()
+{
+    while (!m_deferred_diagnostics.empty())
+    {
+        std::function<void()> task = std::move(m_deferred_diagnostics.front());
+        m_deferred_diagnostics.pop_front();
+        task();
+    }
+}
+
+void GRAMR::finish_diagnostics()
+{
+    run_deferred_diagnostics();
+    m_diagnostics_queue.wait();
+}
+
 void GRAMR::fill_multilevel_ghosts(const VariableType a_var_type,
                                    const Interval &a_comps,
                                    const int a_min_level,
@@ -11,10 +11,18 @@
 #include "Interval.H"
 
 // Other includes
+#include "AsyncTaskQueue.hpp"
+#include "InSituAnalysis.hpp"
 #include "Lagrange.hpp"
+#include "MemoryCheckpoint.hpp"
+#include "RegridProfiler.hpp"
 #include "VariableType.hpp"
+#include "WalltimeMonitor.hpp"
+#include "WarmStart.hpp"
 #include <algorithm>
 #include <chrono>
+#include <deque>
+#include <functional>
 #include <ratio>
 #include <vector>
 
@@ -44,8 +52,97 @@ class GRAMR : public AMR
   public:
     AMRInterpolator<Lagrange<4>> *m_interpolator; //!< The interpolator pointer
 
+    //! Runs diagnostics work that needs no communication (e.g. surface
+    //! integrals and writing small data files on rank 0 or computing the
+    //! constraints on a DiagnosticsSnapshot) in the background if
+    //! async_diagnostics is set. Interpolation and reductions need MPI so
+    //! they stay on the main thread (see defer_diagnostics).
+    AsyncTaskQueue m_diagnostics_queue;
+
+    //! Times the phases of each regrid and measures the grid churn if
+    //! write_regrid_stats is set
+    RegridProfiler m_regrid_profiler;
+
+    //! Stops the run with a checkpoint before the walltime limit or on a
+    //! signal if walltime_limit or checkpoint_on_signal is set
+    WalltimeMonitor m_walltime_monitor;
+
+    //! The last in-memory checkpoint (if memory_checkpoint_interval is set)
+    MemoryCheckpoint m_memory_checkpoint;
+
+    //! The checkpoint the initial data is taken from (if warm_start_file is
+    //! set) while the initial hierarchy is built
+    WarmStart m_warm_start;
+
     GRAMR();
 
+    //! Write an in-memory checkpoint every a_interval coarse steps (0 never)
+    void set_memory_checkpoint_interval(int a_interval)
+    {
+        m_memory_checkpoint_interval = a_interval;
+    }
+
+    //! Check for nans after every coarse step and, if there are any, roll
+    //! back to one of the last a_num_snapshots steps and retry (at most
+    //! a_max_retries times in a row) after multiplying dt by a_dt_factor and
+    //! sigma by a_sigma_factor and, if a_regrid, regridding
+    void set_nan_rollback(int a_max_retries, int a_num_snapshots,
+                          double a_dt_factor, double a_sigma_factor,
+                          bool a_regrid)
+    {
+        m_nan_rollback_max_retries = a_max_retries;
+        m_nan_rollback_num_snapshots = a_num_snapshots;
+        m_nan_rollback_dt_factor = a_dt_factor;
+        m_nan_rollback_sigma_factor = a_sigma_factor;
+        m_nan_rollback_regrid = a_regrid;
+    }
+
+    //! Calls a_analysis with the hierarchy at the end of every a_interval-th
+    //! coarse step (0 never) and, if a_at_plot, whenever plot files are
+    //! written (after prePlotLevel on every level) unless it has already
+    //! been called at the end of that step
+    void add_in_situ_analysis(const InSituAnalysis &a_analysis, int a_interval,
+                              bool a_at_plot = false)
+    {
+        m_in_situ_analyses.push_back({a_analysis, a_interval, a_at_plot});
+    }
+
+    //! Calls the in-situ analyses due at the end of the current coarse step
+    //! or, if a_at_plot, those called when writing plot files (collective)
+    void run_in_situ_analyses(bool a_at_plot);
+
+    int get_finest_level() const { return m_finest_level; }
+
+    //! Adds collective work on the results of m_diagnostics_queue tasks
+    //! (e.g. a reduction, which must wait for them itself) to be run on the
+    //! main thread by the next call of run_deferred_diagnostics
+    void defer_diagnostics(std::function<void()> a_task)
+    {
+        m_deferred_diagnostics.push_back(std::move(a_task));
+    }
+
+    //! Runs the deferred diagnostics in the order they were added
+    //! (collective)
+    void run_deferred_diagnostics();
+
+    //! Runs the deferred diagnostics and waits for m_diagnostics_queue so
+    //! that all the diagnostics output up to now is complete (collective)
+    void finish_diagnostics();
+
+    //! Hides AMR::run in order to run one coarse step at a time (if the
+    //! walltime monitor, in-memory checkpoints or nan rollback are active) so
+    //! that the run can be checkpointed, stopped or rolled back between any
+    //! two steps
+    void run(Real a_max_time, int a_max_step);
+
+    //! Copies the hierarchy into m_memory_checkpoint and each rank's data to
+    //! the next rank (collective)
+    void write_memory_checkpoint();
+
+    //! Rebuilds the hierarchy from m_memory_checkpoint, getting each rank's
+    //! data back from the next rank if a_from_buddy (collective)
+    void read_memory_checkpoint(bool a_from_buddy = false);
+
     // defined here due to auto return type
     auto get_walltime()
     {
@@ -65,12 +162,89 @@ class GRAMR : public AMR
     // const version of above
     std::vector<const GRAMRLevel *> get_gramrlevels() const;
 
+    // Times trial RHS evaluations on the current hierarchy split into boxes
+    // of each of a_box_sizes, prints the fastest on each level and returns
+    // the fastest overall (weighting each level by its number of substeps)
+    int autotune_box_size(const std::vector<int> &a_box_sizes,
+                          int a_num_trials);
+
+    // Sets the max box size of future regrids and splits the current levels
+    // into boxes of at most a_max_box_size (keeping their data)
+    void apply_max_box_size(int a_max_box_size);
+
+    // Prints the cells, memory, ghost exchange volume and time per coarse
+    // step expected on each level (and rank) if the initial hierarchy were
+    // balanced over a_num_ranks (the current number if 0)
+    void dry_run(int a_num_ranks);
+
+    //! Whether the initial hierarchy is only built for dry_run. The levels
+    //! then only need to set the data their tagging criteria (and the timed
+    //! RHS evaluation) use, e.g. an analytic approximation instead of
+    //! solving for the initial data.
+    void set_dry_run(bool a_dry_run) { m_dry_run = a_dry_run; }
+    bool is_dry_run() const { return m_dry_run; }
+
     // Fill ghosts on multiple levels
     void fill_multilevel_ghosts(
         const VariableType a_var_type,
         const Interval &a_comps = Interval(0, std::numeric_limits<int>::max()),
         const int a_min_level = 0,
         const int a_max_level = std::numeric_limits<int>::max()) const;
+
+  protected:
+    bool m_dry_run = false;
+    int m_memory_checkpoint_interval = 0;
+
+    struct in_situ_analysis_t
+    {
+        InSituAnalysis analysis;
+        int interval;
+        bool at_plot;
+        int last_interval_step = -1; //!< the last step it was due at
+    };
+    std::vector<in_situ_analysis_t> m_in_situ_analyses;
+
+    std::deque<std::function<void()>> m_deferred_diagnostics;
+
+    int m_nan_rollback_max_retries = 0; //!< 0 means no nan rollback
+    int m_nan_rollback_num_snapshots = 1;
+    double m_nan_rollback_dt_factor = 0.5;
+    double m_nan_rollback_sigma_factor = 1.;
+    bool m_nan_rollback_regrid = false;
+    //! The hierarchy after each of the last m_nan_rollback_num_snapshots
+    //! coarse steps without nans (oldest first)
+    std::deque<MemoryCheckpoint> m_nan_snapshots;
+
+    //! Copies the hierarchy into a_checkpoint (on this rank only)
+    void fill_memory_checkpoint(MemoryCheckpoint &a_checkpoint) const;
+
+    //! Rebuilds the hierarchy from a_checkpoint (on this rank only)
+    void restore_memory_checkpoint(const MemoryCheckpoint &a_checkpoint);
+
+    //! Stores the current hierarchy as the latest nan snapshot
+    void take_nan_snapshot();
+
+    //! Returns true if any level has a nan on any rank (collective)
+    bool hierarchy_has_nans() const;
+
+    //! The size (over all ranks) of the valid data a checkpoint would write
+    double checkpoint_bytes() const;
+
+    //! Restores a nan snapshot (going one further back on each consecutive
+    //! retry) and applies the remedies
+    void nan_rollback(int a_retry);
+
+    //! Problem specific data to store in (and restore from) an in-memory
+    //! checkpoint. It may differ between ranks (e.g. output state only kept
+    //! on rank 0) and is copied to the buddy with the level data.
+    virtual void
+    specific_write_memory_checkpoint(std::vector<double> &a_extra_data) const
+    {
+    }
+    virtual void
+    specific_read_memory_checkpoint(const std::vector<double> &a_extra_data)
+    {
+    }
 };
 
 #endif /* GRAMR_HPP_ */
@@ -7,11 +7,19 @@
 
 GRAMRLevel::GRAMRLevel(GRAMR &gr_amr, const SimulationParameters &a_p,
                        int a_verbosity)
-    : m_gr_amr(gr_amr), m_p(a_p), m_verbosity(a_verbosity),
-      m_num_ghosts(a_p.num_ghosts)
+    : m_gr_amr(gr_amr), m_p(a_p), m_verbosity(a_verbosity), m_rk_stage(0),
+      m_rhs_halo_filled(false), m_num_ghosts(a_p.num_ghosts),
+      m_num_state_ghosts(a_p.deep_halo_stages * a_p.num_ghosts)
 {
     if (m_verbosity)
         pout() << "GRAMRLevel constructor" << endl;
+
+    if (m_p.use_huge_pages)
+        m_data_factory = RefCountedPtr<DataFactory<FArrayBox>>(
+            new HugePageDataFactory());
+    else
+        m_data_factory = RefCountedPtr<DataFactory<FArrayBox>>(
+            new DefaultDataFactory<FArrayBox>());
 }
 
 GRAMRLevel::~GRAMRLevel() {}
@@ -53,6 +61,93 @@ void GRAMRLevel::define(AMRLevel *a_coarser_level_ptr,
                         m_num_ghosts);
 }
 
+// Returns true if the two layouts have the same boxes on the same ranks
+static bool same_boxes_and_procs(const DisjointBoxLayout &a_lhs,
+                                 const DisjointBoxLayout &a_rhs)
+{
+    if (!a_lhs.isClosed() || !a_rhs.isClosed() || a_lhs.size() != a_rhs.size())
+        return false;
+
+    LayoutIterator lit_lhs = a_lhs.layoutIterator();
+    LayoutIterator lit_rhs = a_rhs.layoutIterator();
+    for (lit_lhs.begin(), lit_rhs.begin(); lit_lhs.ok(); ++lit_lhs, ++lit_rhs)
+    {
+        if (a_lhs[lit_lhs] != a_rhs[lit_rhs] ||
+            a_lhs.procID(lit_lhs()) != a_rhs.procID(lit_rhs()))
+            return false;
+    }
+    return true;
+}
+
+// Returns a_layout with each box extended by a_ghosts across the
+// non-periodic boundaries of a_domain it touches (which keeps the boxes
+// disjoint) and the domain grown to contain them in a_grown_domain
+static DisjointBoxLayout extend_to_boundary(const DisjointBoxLayout &a_layout,
+                                            const ProblemDomain &a_domain,
+                                            const IntVect &a_ghosts,
+                                            ProblemDomain &a_grown_domain)
+{
+    const Box &domain_box = a_domain.domainBox();
+    Box grown_domain_box = domain_box;
+    bool is_periodic[SpaceDim];
+    for (int dir = 0; dir < SpaceDim; ++dir)
+    {
+        is_periodic[dir] = a_domain.isPeriodic(dir);
+        if (!is_periodic[dir])
+            grown_domain_box.grow(dir, a_ghosts[dir]);
+    }
+    a_grown_domain = ProblemDomain(grown_domain_box, is_periodic);
+
+    Vector<Box> boxes;
+    Vector<int> procs;
+    LayoutIterator lit = a_layout.layoutIterator();
+    for (lit.begin(); lit.ok(); ++lit)
+    {
+        Box box = a_layout[lit];
+        for (int dir = 0; dir < SpaceDim; ++dir)
+        {
+            if (is_periodic[dir])
+                continue;
+            if (box.smallEnd(dir) == domain_box.smallEnd(dir))
+                box.growLo(dir, a_ghosts[dir]);
+            if (box.bigEnd(dir) == domain_box.bigEnd(dir))
+                box.growHi(dir, a_ghosts[dir]);
+        }
+        boxes.push_back(box);
+        procs.push_back(a_layout.procID(lit()));
+    }
+    DisjointBoxLayout extended_layout(boxes, procs, a_grown_domain);
+    extended_layout.close();
+    return extended_layout;
+}
+
+// Copies between the local boxes of two layouts where one box contains the
+// other (e.g. a box and the same box extended to the boundary) on the region
+// both FABs cover
+static void copy_matching_boxes(const LevelData<FArrayBox> &a_src,
+                                LevelData<FArrayBox> &a_dest)
+{
+    const DisjointBoxLayout &src_layout = a_src.disjointBoxLayout();
+    const DisjointBoxLayout &dest_layout = a_dest.disjointBoxLayout();
+    DataIterator dest_dit = dest_layout.dataIterator();
+    DataIterator src_dit = src_layout.dataIterator();
+    for (dest_dit.begin(); dest_dit.ok(); ++dest_dit)
+    {
+        const Box &dest_box = dest_layout[dest_dit];
+        for (src_dit.begin(); src_dit.ok(); ++src_dit)
+        {
+            const Box &src_box = src_layout[src_dit];
+            if (src_box.contains(dest_box) || dest_box.contains(src_box))
+            {
+                FArrayBox &dest_fab = a_dest[dest_dit];
+                const FArrayBox &src_fab = a_src[src_dit];
+                dest_fab.copy(src_fab, src_fab.box() & dest_fab.box());
+                break;
+            }
+        }
+    }
+}
+
 /// Do casting from AMRLevel to GRAMRLevel and stop if this isn't possible
 const GRAMRLevel *GRAMRLevel::gr_cast(const AMRLevel *const amr_level_ptr)
 {
@@ -107,11 +202,7 @@ Real GRAMRLevel::advance()
         printProgress("GRAMRLevel::advance");
 
     // copy soln to old state to save it
-    m_state_new.copyTo(m_state_new.interval(), m_state_old,
-                       m_state_old.interval());
-
-    // Specifically copy boundary cells
-    copyBdyGhosts(m_state_new, m_state_old);
+    copySolnData(m_state_old, m_state_new);
 
     // The level classes take flux-register parameters, use dummy ones here
     LevelFluxRegister *coarser_fr = nullptr;
@@ -137,9 +228,19 @@ Real GRAMRLevel::advance()
         t_coarser_old = t_coarser_new - coarser_gr_amr_level_ptr->m_dt;
     }
 
+    m_rk_stage = 0;
+    if (m_p.deep_halo_stages > 1)
+    {
+        // every stage starts from a copy of the old state so exchange its
+        // whole halo once here rather than in evalRHS
+        m_state_old.exchange(m_halo_exchange_copier);
+    }
+
     if (m_finer_level_ptr != nullptr)
     {
         GRAMRLevel *fine_gr_amr_level_ptr = gr_cast(m_finer_level_ptr);
+        // the finer level's time interpolator is about to be refilled
+        fine_gr_amr_level_ptr->m_cf_ghost_cache.clear();
         RK4LevelAdvance(m_state_new, m_state_old,
                         fine_gr_amr_level_ptr->m_patcher.getTimeInterpolator(),
                         *coarser_data_old, t_coarser_old, *coarser_data_new,
@@ -182,6 +283,13 @@ void GRAMRLevel::postTimeStep()
     // and postentially after specificPostTimeStep actions
     fillBdyGhosts(m_state_new);
 
+    // the end of a coarse step (all finer levels have been averaged down)
+    if (m_level == 0)
+    {
+        m_gr_amr.run_in_situ_analyses(false);
+        SmallDataIOBuffer::step_finished();
+    }
+
     if (m_verbosity)
         pout() << "GRAMRLevel::postTimeStep " << m_level << " finished" << endl;
 }
@@ -201,6 +309,10 @@ void GRAMRLevel::tagCells(IntVectSet &a_tags)
     if (m_verbosity)
         pout() << "GRAMRLevel::tagCells " << m_level << endl;
 
+    RegridProfiler &profiler = m_gr_amr.m_regrid_profiler;
+    profiler.start_regrid();
+    RegridProfiler::ScopedTimer timer(profiler, RegridProfiler::TAG_CELLS);
+
     preTagCells();
 
     IntVectSet local_tags;
@@ -256,6 +368,8 @@ void GRAMRLevel::tagCells(IntVectSet &a_tags)
     local_tags &= local_tags_box;
 
     a_tags = local_tags;
+
+    profiler.tagging_finished();
 }
 
 // create tags at initialization
@@ -265,6 +379,14 @@ void GRAMRLevel::tagCellsInit(IntVectSet &a_tags)
     tagCells(a_tags);
 }
 
+// things to do once the new grids are known but before regridding
+void GRAMRLevel::preRegrid(int a_base_level,
+                           const Vector<Vector<Box>> &a_new_grids)
+{
+    // the time since the last tagging was spent making the new grids
+    m_gr_amr.m_regrid_profiler.clustering_finished();
+}
+
 // regrid
 void GRAMRLevel::regrid(const Vector<Box> &a_new_grids)
 {
@@ -273,44 +395,66 @@ void GRAMRLevel::regrid(const Vector<Box> &a_new_grids)
     if (m_verbosity)
         pout() << "GRAMRLevel::regrid " << m_level << endl;
 
+    RegridProfiler &profiler = m_gr_amr.m_regrid_profiler;
+
+    // keep the old grids to work out which regions are newly refined
+    const Vector<Box> old_level_grids = m_level_grids;
+    const DisjointBoxLayout old_level_domain = m_grids;
     m_level_grids = a_new_grids;
 
     mortonOrdering(m_level_grids);
     const DisjointBoxLayout level_domain = m_grids = loadBalance(a_new_grids);
-
-    // save data for later copy, including boundary cells
-    m_state_new.copyTo(m_state_new.interval(), m_state_old,
-                       m_state_old.interval());
-
-    // Specifically copy boundary cells
-    copyBdyGhosts(m_state_new, m_state_old);
+    profiler.add_churn(m_level, old_level_domain, level_domain, NUM_VARS);
 
     // reshape state with new grids
     IntVect iv_ghosts = m_num_ghosts * IntVect::Unit;
-    m_state_new.define(level_domain, NUM_VARS, iv_ghosts);
+    IntVect iv_state_ghosts = m_num_state_ghosts * IntVect::Unit;
+    if (m_state_new.isDefined())
+    {
+        // The old time solution is not needed so swap the solution into
+        // m_state_old (without copying) and then move it onto the new grids.
+        // Unchanged boxes on the same rank keep their data in place and only
+        // the changed boxes are transferred
+        CH_TIME("GRAMRLevel::regrid::moveData");
+        RegridProfiler::ScopedTimer timer(profiler, RegridProfiler::MOVE_DATA);
+        m_state_old.swap(m_state_new);
+        m_state_new.defineFrom(m_state_old, level_domain, *m_data_factory);
+    }
+    else
+    {
+        m_state_new.define(level_domain, NUM_VARS, iv_state_ghosts,
+                           *m_data_factory);
+    }
 
     // maintain interlevel stuff
-    defineExchangeCopier(level_domain);
-    m_coarse_average.define(level_domain, NUM_VARS, m_ref_ratio);
-    m_fine_interp.define(level_domain, NUM_VARS, m_ref_ratio, m_problem_domain);
+    defineLevelOperators(level_domain);
 
-    if (m_coarser_level_ptr != nullptr)
+    // the old data has been moved so the old time state can be redefined
+    // (before the interpolation, which may use it as scratch space)
     {
-        GRAMRLevel *coarser_gr_amr_level_ptr = gr_cast(m_coarser_level_ptr);
-        m_patcher.define(level_domain, coarser_gr_amr_level_ptr->m_grids,
-                         NUM_VARS, coarser_gr_amr_level_ptr->problemDomain(),
-                         m_ref_ratio, m_num_ghosts);
+        CH_TIME("GRAMRLevel::regrid::defineData");
+        RegridProfiler::ScopedTimer timer(profiler,
+                                          RegridProfiler::DEFINE_DATA);
+        m_state_old.define(level_domain, NUM_VARS, iv_state_ghosts,
+                           *m_data_factory);
         if (NUM_DIAGNOSTIC_VARS > 0)
         {
-            m_patcher_diagnostics.define(
-                level_domain, coarser_gr_amr_level_ptr->m_grids,
-                NUM_DIAGNOSTIC_VARS, coarser_gr_amr_level_ptr->problemDomain(),
-                m_ref_ratio, m_num_ghosts);
+            m_state_diagnostics.define(level_domain, NUM_DIAGNOSTIC_VARS,
+                                       iv_ghosts, *m_data_factory);
         }
+    }
 
-        // interpolate from coarser level
-        m_fine_interp.interpToFine(m_state_new,
-                                   coarser_gr_amr_level_ptr->m_state_new);
+    if (m_coarser_level_ptr != nullptr)
+    {
+        CH_TIME("GRAMRLevel::regrid::interpolate");
+        RegridProfiler::ScopedTimer timer(profiler,
+                                          RegridProfiler::INTERPOLATE);
+        GRAMRLevel *coarser_gr_amr_level_ptr = gr_cast(m_coarser_level_ptr);
+
+        // interpolate from coarser level (only where there was no fine data)
+        interpToFineUncovered(old_level_grids,
+                              coarser_gr_amr_level_ptr->m_state_new,
+                              m_state_old);
 
         // also interpolate fine boundary cells
         if (m_p.boundary_params.nonperiodic_boundaries_exist)
@@ -322,24 +466,9 @@ void GRAMRLevel::regrid(const Vector<Box> &a_new_grids)
         }
     }
 
-    // copy from old state
-    m_state_old.copyTo(m_state_old.interval(), m_state_new,
-                       m_state_new.interval());
-
-    // Specifically copy boundary cells (only if same layout, otherwise
-    // interpolated)
-    copyBdyGhosts(m_state_old, m_state_new);
-
     // enforce solution BCs (overwriting any interpolation)
     fillBdyGhosts(m_state_new);
 
-    m_state_old.define(level_domain, NUM_VARS, iv_ghosts);
-    if (NUM_DIAGNOSTIC_VARS > 0)
-    {
-        m_state_diagnostics.define(level_domain, NUM_DIAGNOSTIC_VARS,
-                                   iv_ghosts);
-    }
-
     // if 'print_progress_only_to_rank_0', print progress only on regrids
     // (except for rank 0, which kept doing prints)
     // print here instead of 'postRegrid' to avoid prints in reverse level order
@@ -356,6 +485,13 @@ void GRAMRLevel::postRegrid(int a_base_level)
         GRAMRLevel *coarser_gr_amr_level_ptr = gr_cast(m_coarser_level_ptr);
         m_restart_time = coarser_gr_amr_level_ptr->m_restart_time;
     }
+
+    // this is called on the base level last
+    if (m_level == a_base_level)
+    {
+        m_gr_amr.m_regrid_profiler.write(m_p.data_path, m_time, m_dt,
+                                         m_restart_time);
+    }
 }
 
 // initialize grid
@@ -371,36 +507,46 @@ void GRAMRLevel::initialGrid(const Vector<Box> &a_new_grids)
     const DisjointBoxLayout level_domain = m_grids = loadBalance(a_new_grids);
 
     IntVect iv_ghosts = m_num_ghosts * IntVect::Unit;
-    m_state_new.define(level_domain, NUM_VARS, iv_ghosts);
-    m_state_old.define(level_domain, NUM_VARS, iv_ghosts);
+    IntVect iv_state_ghosts = m_num_state_ghosts * IntVect::Unit;
+    m_state_new.define(level_domain, NUM_VARS, iv_state_ghosts,
+                       *m_data_factory);
+    m_state_old.define(level_domain, NUM_VARS, iv_state_ghosts,
+                       *m_data_factory);
     if (NUM_DIAGNOSTIC_VARS > 0)
     {
         m_state_diagnostics.define(level_domain, NUM_DIAGNOSTIC_VARS,
-                                   iv_ghosts);
+                                   iv_ghosts, *m_data_factory);
     }
 
-    defineExchangeCopier(level_domain);
-    m_coarse_average.define(level_domain, NUM_VARS, m_ref_ratio);
-    m_fine_interp.define(level_domain, NUM_VARS, m_ref_ratio, m_problem_domain);
+    defineLevelOperators(level_domain);
+}
+
+bool GRAMRLevel::warmStartData()
+{
+    if (!m_gr_amr.m_warm_start.is_active())
+        return false;
+
+    CH_TIME("GRAMRLevel::warmStartData");
+    if (m_verbosity)
+        pout() << "GRAMRLevel::warmStartData " << m_level << endl;
 
     if (m_coarser_level_ptr != nullptr)
     {
-        GRAMRLevel *coarser_gr_amr_level_ptr = gr_cast(m_coarser_level_ptr);
-        m_patcher.define(level_domain, coarser_gr_amr_level_ptr->m_grids,
-                         NUM_VARS, coarser_gr_amr_level_ptr->problemDomain(),
-                         m_ref_ratio, m_num_ghosts);
-        if (NUM_DIAGNOSTIC_VARS > 0)
-        {
-            m_patcher_diagnostics.define(
-                level_domain, coarser_gr_amr_level_ptr->m_grids,
-                NUM_DIAGNOSTIC_VARS, coarser_gr_amr_level_ptr->problemDomain(),
-                m_ref_ratio, m_num_ghosts);
-        }
+        m_fine_interp.interpToFine(m_state_new,
+                                   gr_cast(m_coarser_level_ptr)->m_state_new);
     }
+    m_gr_amr.m_warm_start.fill(m_state_new, m_dx, m_problem_domain);
+    return true;
 }
 
 // things to do after initialization
-void GRAMRLevel::postInitialize() { m_restart_time = 0.; }
+void GRAMRLevel::postInitialize()
+{
+    m_restart_time = 0.;
+
+    // the initial grid generation is not a regrid
+    m_gr_amr.m_regrid_profiler.reset();
+}
 
 // compute dt
 Real GRAMRLevel::computeDt()
@@ -423,16 +569,20 @@ Real GRAMRLevel::computeInitialDt()
 DisjointBoxLayout GRAMRLevel::loadBalance(const Vector<Box> &a_grids)
 {
     CH_TIME("GRAMRLevel::loadBalance");
+    RegridProfiler::ScopedTimer timer(m_gr_amr.m_regrid_profiler,
+                                      RegridProfiler::LOAD_BALANCE);
 
     // load balance and create boxlayout
-    Vector<int> procMap;
-
     // appears to be faster for all procs to do the loadbalance (ndk)
-    LoadBalance(procMap, a_grids);
+    const Vector<int> procMap = assignRanks(a_grids, numProc());
+    const int num_lb_procs = numLoadBalanceRanks(a_grids.size(), numProc());
 
     if (m_verbosity == 1)
     {
         pout() << "GRAMRLevel::::loadBalance" << endl;
+        if (num_lb_procs < numProc())
+            pout() << "Level " << m_level << " agglomerated onto "
+                   << num_lb_procs << " ranks" << endl;
     }
     else if (m_verbosity > 1)
     {
@@ -447,9 +597,629 @@ DisjointBoxLayout GRAMRLevel::loadBalance(const Vector<Box> &a_grids)
     DisjointBoxLayout dbl(a_grids, procMap, m_problem_domain);
     dbl.close();
 
+    // keep the current layout (and hence everything defined on it) if the
+    // boxes and their ranks are unchanged
+    if (same_boxes_and_procs(dbl, m_grids))
+        return m_grids;
+
     return dbl;
 }
 
+int GRAMRLevel::numLoadBalanceRanks(int a_num_boxes, int a_num_ranks) const
+{
+    // agglomerate levels with few boxes onto a subset of the ranks so that
+    // their exchanges, averaging and interpolation only involve those ranks
+    int num_lb_procs = a_num_ranks;
+    if (m_p.agglomeration_boxes_per_rank > 0)
+    {
+        const int num_agglomerated_procs =
+            (a_num_boxes + m_p.agglomeration_boxes_per_rank - 1) /
+            m_p.agglomeration_boxes_per_rank;
+        num_lb_procs =
+            std::max(1, std::min(num_lb_procs, num_agglomerated_procs));
+    }
+    return num_lb_procs;
+}
+
+Vector<int> GRAMRLevel::assignRanks(const Vector<Box> &a_grids,
+                                    int a_num_ranks) const
+{
+    Vector<int> procMap;
+    const int num_lb_procs = numLoadBalanceRanks(a_grids.size(), a_num_ranks);
+    LoadBalance(procMap, a_grids, num_lb_procs);
+
+    // spread the subset evenly over all the ranks (and hence nodes)
+    if (num_lb_procs < a_num_ranks)
+    {
+        const int proc_stride = a_num_ranks / num_lb_procs;
+        for (int igrid = 0; igrid < procMap.size(); ++igrid)
+            procMap[igrid] *= proc_stride;
+    }
+    return procMap;
+}
+
+void GRAMRLevel::defineLevelOperators(const DisjointBoxLayout &a_level_domain)
+{
+    CH_TIME("GRAMRLevel::defineLevelOperators");
+    RegridProfiler::ScopedTimer timer(m_gr_amr.m_regrid_profiler,
+                                      RegridProfiler::DEFINE_OPERATORS);
+
+    // these only depend on the grids on this level
+    const bool level_changed = !(m_operators_grids == a_level_domain);
+    if (level_changed)
+    {
+        defineExchangeCopier(a_level_domain);
+        m_coarse_average.define(a_level_domain, NUM_VARS, m_ref_ratio);
+        m_fine_interp.define(a_level_domain, NUM_VARS, m_ref_ratio,
+                             m_problem_domain);
+        m_operators_grids = a_level_domain;
+    }
+
+    // and these also depend on the coarser grids
+    bool coarser_changed = false;
+    if (m_coarser_level_ptr != nullptr)
+    {
+        GRAMRLevel *coarser_gr_amr_level_ptr = gr_cast(m_coarser_level_ptr);
+        const DisjointBoxLayout &coarser_grids =
+            coarser_gr_amr_level_ptr->m_grids;
+        coarser_changed = !(m_operators_coarser_grids == coarser_grids);
+        if (level_changed || coarser_changed)
+        {
+            m_patcher.define(a_level_domain, coarser_grids, NUM_VARS,
+                             coarser_gr_amr_level_ptr->problemDomain(),
+                             m_ref_ratio, m_num_state_ghosts);
+            if (NUM_DIAGNOSTIC_VARS > 0)
+            {
+                m_patcher_diagnostics.define(
+                    a_level_domain, coarser_grids, NUM_DIAGNOSTIC_VARS,
+                    coarser_gr_amr_level_ptr->problemDomain(), m_ref_ratio,
+                    m_num_ghosts);
+            }
+            m_operators_coarser_grids = coarser_grids;
+        }
+    }
+
+    if (m_verbosity)
+    {
+        pout() << "GRAMRLevel::defineLevelOperators: level " << m_level
+               << (level_changed ? " redefined" : " reused")
+               << " level operators, "
+               << ((level_changed || coarser_changed) ? "redefined"
+                                                       : "reused")
+               << " coarse-fine operators" << endl;
+    }
+}
+
+void GRAMRLevel::interpToFineUncovered(const Vector<Box> &a_old_grids,
+                                       const GRLevelData &a_coarse_state,
+                                       GRLevelData &a_scratch)
+{
+    CH_TIME("GRAMRLevel::interpToFineUncovered");
+
+    const DisjointBoxLayout &level_domain = m_state_new.disjointBoxLayout();
+
+    // Find the parts of the new boxes not covered by the old boxes. All boxes
+    // should be multiples of block_factor, so this is done on the coarsened
+    // blocks, which keeps the result coarsenable by m_ref_ratio. If any box
+    // is not a multiple of block_factor, the coarsened cells (m_ref_ratio)
+    // are used instead. Interpolating everywhere is no fallback here: the old
+    // data has already been moved into m_state_new and would be overwritten
+    int block_factor = m_p.block_factor;
+    for (int ibox = 0; ibox < a_old_grids.size(); ++ibox)
+    {
+        if (!a_old_grids[ibox].coarsenable(block_factor))
+            block_factor = m_ref_ratio;
+    }
+    LayoutIterator lit = level_domain.layoutIterator();
+    for (lit.begin(); lit.ok(); ++lit)
+    {
+        if (!level_domain[lit].coarsenable(block_factor))
+            block_factor = m_ref_ratio;
+    }
+
+    // Put the old boxes in bins at least as large as any of them so that each
+    // new box is only compared with the old boxes in the (at most 2^D) bins
+    // it touches rather than with all of them
+    Vector<Box> coarsened_old_grids;
+    int bin_size = 1;
+    for (int ibox = 0; ibox < a_old_grids.size(); ++ibox)
+    {
+        coarsened_old_grids.push_back(coarsen(a_old_grids[ibox], block_factor));
+        for (int idir = 0; idir < SpaceDim; ++idir)
+        {
+            bin_size =
+                std::max(bin_size, coarsened_old_grids[ibox].size(idir));
+        }
+    }
+    const Box bins_box =
+        coarsen(coarsen(m_problem_domain.domainBox(), block_factor), bin_size);
+    std::unordered_map<long, std::vector<int>> old_boxes_in_bin;
+    for (int ibox = 0; ibox < coarsened_old_grids.size(); ++ibox)
+    {
+        const Box bins = coarsen(coarsened_old_grids[ibox], bin_size);
+        for (BoxIterator bit(bins); bit.ok(); ++bit)
+            old_boxes_in_bin[bins_box.index(bit())].push_back(ibox);
+    }
+
+    // the uncovered parts of a_new_box (refined back to this level)
+    std::vector<int> last_compared(coarsened_old_grids.size(), -1);
+    int num_compared = 0;
+    bool any_covered = false;
+    auto find_uncovered = [&](const Box &a_new_box) {
+        const Box coarsened_new_box = coarsen(a_new_box, block_factor);
+        IntVectSet uncovered(coarsened_new_box);
+        const Box bins = coarsen(coarsened_new_box, bin_size);
+        for (BoxIterator bit(bins); bit.ok(); ++bit)
+        {
+            auto bin_it = old_boxes_in_bin.find(bins_box.index(bit()));
+            if (bin_it == old_boxes_in_bin.end())
+                continue;
+            for (int ibox : bin_it->second)
+            {
+                // an old box can be in several of the bins
+                if (last_compared[ibox] == num_compared)
+                    continue;
+                last_compared[ibox] = num_compared;
+                if (coarsened_new_box.intersectsNotEmpty(
+                        coarsened_old_grids[ibox]))
+                {
+                    uncovered -= coarsened_old_grids[ibox];
+                    any_covered = true;
+                }
+            }
+        }
+        ++num_compared;
+        Vector<Box> uncovered_pieces = uncovered.boxes();
+        for (int ipiece = 0; ipiece < uncovered_pieces.size(); ++ipiece)
+            uncovered_pieces[ipiece].refine(block_factor);
+        return uncovered_pieces;
+    };
+
+    Vector<Box> uncovered_boxes;
+    Vector<int> uncovered_procs;
+    long long num_cells = 0;
+    long long num_uncovered_cells = 0;
+    for (lit.begin(); lit.ok(); ++lit)
+    {
+        num_cells += level_domain[lit].numPts();
+        const Vector<Box> uncovered_pieces = find_uncovered(level_domain[lit]);
+        for (int ipiece = 0; ipiece < uncovered_pieces.size(); ++ipiece)
+        {
+            // keep the pieces on the same rank as the box they came from so
+            // the final copy is local
+            uncovered_boxes.push_back(uncovered_pieces[ipiece]);
+            uncovered_procs.push_back(level_domain.procID(lit()));
+            num_uncovered_cells += uncovered_pieces[ipiece].numPts();
+        }
+    }
+
+    // nothing to gain (e.g. a new level) so interpolate everywhere as before
+    if (!any_covered)
+    {
+        m_fine_interp.interpToFine(m_state_new, a_coarse_state);
+        return;
+    }
+
+    if (uncovered_boxes.size() == 0)
+        return;
+
+    // Each fine cell is interpolated from the coarse data alone, so the
+    // values on the uncovered cells are the same however many of the other
+    // cells are interpolated too. Setting up an interpolator for the
+    // uncovered boxes costs about as much as using it. If most of the level
+    // is uncovered, it is cheaper to interpolate the whole level with the
+    // existing m_fine_interp. This goes into a_scratch because the covered
+    // cells of m_state_new already hold the moved data
+    if (num_uncovered_cells > m_p.regrid_max_uncovered_fraction * num_cells)
+    {
+        m_fine_interp.interpToFine(a_scratch, a_coarse_state);
+        DataIterator dit = level_domain.dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+        {
+            const Vector<Box> uncovered_pieces =
+                find_uncovered(level_domain[dit]);
+            for (int ipiece = 0; ipiece < uncovered_pieces.size(); ++ipiece)
+                m_state_new[dit].copy(a_scratch[dit], uncovered_pieces[ipiece]);
+        }
+        return;
+    }
+
+    DisjointBoxLayout uncovered_domain(uncovered_boxes, uncovered_procs,
+                                       m_problem_domain);
+    uncovered_domain.close();
+    LevelData<FArrayBox> uncovered_state(uncovered_domain, NUM_VARS);
+    FourthOrderFineInterp uncovered_interp;
+    uncovered_interp.define(uncovered_domain, NUM_VARS, m_ref_ratio,
+                            m_problem_domain);
+    uncovered_interp.interpToFine(uncovered_state, a_coarse_state);
+    uncovered_state.copyTo(uncovered_state.interval(), m_state_new,
+                           m_state_new.interval());
+}
+
+void GRAMRLevel::resplitGrids(int a_max_box_size)
+{
+    CH_TIME("GRAMRLevel::resplitGrids");
+
+    const Vector<Box> new_grids = splitGrids(a_max_box_size);
+    if (!m_p.boundary_params.nonperiodic_boundaries_exist)
+    {
+        regrid(new_grids);
+        return;
+    }
+
+    // The valid cells are moved by regrid but the boundary ghosts of the
+    // changed boxes are not (and are interpolated on the finer levels or, for
+    // Sommerfeld BCs on level 0, not set at all) so keep a copy of them on the
+    // boxes extended to the boundary and copy them back afterwards
+    const IntVect boundary_ghosts = m_num_ghosts * IntVect::Unit;
+    ProblemDomain grown_domain;
+    const DisjointBoxLayout old_extended_grids = extend_to_boundary(
+        m_grids, m_problem_domain, boundary_ghosts, grown_domain);
+    LevelData<FArrayBox> old_data(old_extended_grids, NUM_VARS,
+                                  IntVect::Zero);
+    copy_matching_boxes(m_state_new, old_data);
+
+    regrid(new_grids);
+
+    const DisjointBoxLayout new_extended_grids = extend_to_boundary(
+        m_grids, m_problem_domain, boundary_ghosts, grown_domain);
+    LevelData<FArrayBox> new_data(new_extended_grids, NUM_VARS,
+                                  IntVect::Zero);
+    old_data.copyTo(old_data.interval(), new_data, new_data.interval());
+    copy_matching_boxes(new_data, m_state_new);
+}
+
+Vector<Box> GRAMRLevel::splitGrids(int a_max_box_size) const
+{
+    // Merge the current boxes (on the block_factor coarsened grid so that the
+    // merged boxes stay multiples of it) and split them to the given size
+    const int block_factor = m_p.block_factor;
+    IntVectSet coarsened_cover;
+    for (int ibox = 0; ibox < m_level_grids.size(); ++ibox)
+        coarsened_cover |= coarsen(m_level_grids[ibox], block_factor);
+    Vector<Box> merged_boxes = coarsened_cover.boxes();
+    Vector<Box> split_grids;
+    for (int ibox = 0; ibox < merged_boxes.size(); ++ibox)
+    {
+        Vector<Box> split_boxes;
+        domainSplit(refine(merged_boxes[ibox], block_factor), split_boxes,
+                    a_max_box_size, block_factor);
+        split_grids.append(split_boxes);
+    }
+    return split_grids;
+}
+
+double GRAMRLevel::timeBoxSizeTrial(int a_max_box_size, int a_num_trials)
+{
+    CH_TIME("GRAMRLevel::timeBoxSizeTrial");
+
+    Vector<Box> trial_boxes = splitGrids(a_max_box_size);
+    mortonOrdering(trial_boxes);
+    const DisjointBoxLayout trial_grids = loadBalance(trial_boxes);
+
+    IntVect iv_ghosts = m_num_ghosts * IntVect::Unit;
+    GRLevelData trial_soln, trial_rhs;
+    trial_soln.define(trial_grids, NUM_VARS, iv_ghosts, *m_data_factory);
+    trial_rhs.define(trial_grids, NUM_VARS, IntVect::Zero, *m_data_factory);
+    trial_soln.setVal(0.);
+    m_state_new.copyTo(m_state_new.interval(), trial_soln,
+                       trial_soln.interval());
+
+    // the same operators as a real RHS evaluation would use
+    DisjointBoxLayout trial_grown_grids = trial_grids;
+    if (m_p.boundary_params.nonperiodic_boundaries_exist)
+        m_boundaries.expand_grids_to_boundaries(trial_grown_grids, trial_grids);
+    Copier trial_exchange_copier;
+    trial_exchange_copier.exchangeDefine(trial_grown_grids, iv_ghosts);
+
+    GRAMRLevel *coarser_gr_amr_level_ptr = nullptr;
+    FourthOrderFillPatch trial_patcher;
+    if (m_coarser_level_ptr != nullptr)
+    {
+        coarser_gr_amr_level_ptr = gr_cast(m_coarser_level_ptr);
+        trial_patcher.define(trial_grids, coarser_gr_amr_level_ptr->m_grids,
+                             NUM_VARS,
+                             coarser_gr_amr_level_ptr->problemDomain(),
+                             m_ref_ratio, m_num_ghosts);
+    }
+
+    // the first evaluation is not timed as it warms up the caches
+    double elapsed_time = 0.;
+    for (int itrial = 0; itrial <= a_num_trials; ++itrial)
+    {
+        const auto start_time = std::chrono::steady_clock::now();
+        trial_soln.exchange(trial_exchange_copier);
+        if (coarser_gr_amr_level_ptr != nullptr)
+        {
+            trial_patcher.fillInterp(trial_soln,
+                                     coarser_gr_amr_level_ptr->m_state_new, 0,
+                                     0, NUM_VARS);
+        }
+        fillBdyGhosts(trial_soln);
+        specificEvalRHS(trial_soln, trial_rhs, m_time);
+        if (itrial > 0)
+        {
+            elapsed_time += std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - start_time)
+                                .count();
+        }
+    }
+    elapsed_time /= a_num_trials;
+
+    // the slowest rank determines the time taken
+#ifdef CH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &elapsed_time, 1, MPI_DOUBLE, MPI_MAX,
+                  Chombo_MPI::comm);
+#endif
+
+    if (m_verbosity)
+    {
+        pout() << "GRAMRLevel::timeBoxSizeTrial: level " << m_level << " with "
+               << trial_grids.size() << " boxes of max size "
+               << a_max_box_size << " took " << elapsed_time << "s" << endl;
+    }
+
+    return elapsed_time;
+}
+
+DryRunEstimate::level_t GRAMRLevel::estimateDryRun(int a_num_ranks,
+                                                   bool a_measure_time)
+{
+    CH_TIME("GRAMRLevel::estimateDryRun");
+
+    DryRunEstimate::level_t estimate;
+    const Vector<int> procs = assignRanks(m_level_grids, a_num_ranks);
+    estimate.num_boxes = m_level_grids.size();
+    estimate.rank_cells.assign(a_num_ranks, 0);
+    estimate.rank_bytes.assign(a_num_ranks, {});
+    estimate.rank_comm_bytes.assign(a_num_ranks, 0);
+
+    const IntVect iv_ghosts = m_num_ghosts * IntVect::Unit;
+    const IntVect iv_state_ghosts = m_num_state_ghosts * IntVect::Unit;
+    const IntVect iv_rhs_ghosts = iv_state_ghosts - iv_ghosts;
+    const long long state_cell_bytes = NUM_VARS * sizeof(Real);
+    const long long diagnostic_cell_bytes = NUM_DIAGNOSTIC_VARS * sizeof(Real);
+    const Box &domain_box = m_problem_domain.domainBox();
+    const IntVect domain_size = domain_box.size();
+
+    // the whole halo is exchanged at the start of each step and then before
+    // every deep_halo_stages-th of the 4 RK4 stages (see evalRHS)
+    estimate.exchanges_per_step =
+        (4 + m_p.deep_halo_stages - 1) / m_p.deep_halo_stages;
+
+    // Put the boxes in bins at least as large as any of them so that each
+    // ghosted box is only compared with the boxes in the bins it touches
+    int bin_size = 1;
+    for (int ibox = 0; ibox < m_level_grids.size(); ++ibox)
+    {
+        for (int idir = 0; idir < SpaceDim; ++idir)
+            bin_size = std::max(bin_size, m_level_grids[ibox].size(idir));
+    }
+    const Box bins_box = coarsen(domain_box, bin_size);
+    std::unordered_map<long, std::vector<int>> boxes_in_bin;
+    for (int ibox = 0; ibox < m_level_grids.size(); ++ibox)
+    {
+        const Box bins = coarsen(m_level_grids[ibox], bin_size);
+        for (BoxIterator bit(bins); bit.ok(); ++bit)
+            boxes_in_bin[bins_box.index(bit())].push_back(ibox);
+    }
+    std::vector<int> last_compared(m_level_grids.size(), -1);
+    int num_compared = 0;
+
+    for (int ibox = 0; ibox < m_level_grids.size(); ++ibox)
+    {
+        const Box &box = m_level_grids[ibox];
+        const int rank = procs[ibox];
+        const Box state_box = grow(box, iv_state_ghosts);
+        estimate.num_cells += box.numPts();
+        estimate.num_ghost_cells += state_box.numPts() - box.numPts();
+        estimate.rank_cells[rank] += box.numPts();
+
+        auto &bytes = estimate.rank_bytes[rank];
+        bytes[DryRunEstimate::STATE] += state_box.numPts() * state_cell_bytes;
+        bytes[DryRunEstimate::OLD_STATE] +=
+            state_box.numPts() * state_cell_bytes;
+        // the stage solution and the RHS (with a halo in deep halo mode)
+        bytes[DryRunEstimate::RK_STAGES] +=
+            (state_box.numPts() + grow(box, iv_rhs_ghosts).numPts()) *
+            state_cell_bytes;
+        bytes[DryRunEstimate::DIAGNOSTICS] +=
+            grow(box, iv_ghosts).numPts() * diagnostic_cell_bytes;
+        // four Taylor coefficients of the coarse data under the ghosted box
+        if (m_coarser_level_ptr != nullptr)
+        {
+            const Box coarse_box =
+                grow(coarsen(state_box, m_coarser_level_ptr->refRatio()), 1);
+            bytes[DryRunEstimate::INTERPOLATION] +=
+                4 * coarse_box.numPts() * state_cell_bytes;
+        }
+
+        // the halo cells received from boxes on other ranks, including
+        // periodic images (intersecting the halo shifted back into the
+        // domain with a box is the same as intersecting it with the shifted
+        // box)
+        std::vector<Box> halo_images = {state_box};
+        if (!domain_box.contains(state_box))
+        {
+            ShiftIterator shift_it = m_problem_domain.shiftIterator();
+            for (shift_it.begin(); shift_it.ok(); ++shift_it)
+            {
+                halo_images.push_back(
+                    shift(state_box, -domain_size * shift_it()));
+            }
+        }
+        long long comm_cells = 0;
+        for (const Box &halo_image : halo_images)
+        {
+            const Box bins = coarsen(halo_image, bin_size) & bins_box;
+            for (BoxIterator bit(bins); bit.ok(); ++bit)
+            {
+                auto bin_it = boxes_in_bin.find(bins_box.index(bit()));
+                if (bin_it == boxes_in_bin.end())
+                    continue;
+                for (int jbox : bin_it->second)
+                {
+                    // a box can be in several of the bins
+                    if (last_compared[jbox] == num_compared ||
+                        procs[jbox] == rank)
+                    {
+                        continue;
+                    }
+                    last_compared[jbox] = num_compared;
+                    comm_cells += (halo_image & m_level_grids[jbox]).numPts();
+                }
+            }
+            ++num_compared;
+        }
+        estimate.rank_comm_bytes[rank] += comm_cells * state_cell_bytes;
+    }
+
+    // time an RHS evaluation on the current ranks and divide by the cells on
+    // the most loaded one
+    if (a_measure_time && m_p.max_grid_size > 0)
+    {
+        const double rhs_time = timeBoxSizeTrial(m_p.max_grid_size, 1);
+        const Vector<int> current_procs = assignRanks(m_level_grids, numProc());
+        std::vector<long long> current_rank_cells(numProc(), 0);
+        for (int ibox = 0; ibox < m_level_grids.size(); ++ibox)
+        {
+            current_rank_cells[current_procs[ibox]] +=
+                m_level_grids[ibox].numPts();
+        }
+        const long long max_cells = *std::max_element(
+            current_rank_cells.begin(), current_rank_cells.end());
+        if (max_cells > 0)
+            estimate.cell_time = rhs_time / max_cells;
+    }
+
+    return estimate;
+}
+
+void GRAMRLevel::writeMemoryCheckpointLevel(
+    MemoryCheckpoint::level_t &a_level) const
+{
+    CH_TIME("GRAMRLevel::writeMemoryCheckpointLevel");
+
+    a_level.time = m_time;
+    a_level.dt = m_dt;
+    a_level.dt_multiplier = m_p.dt_multiplier;
+    a_level.boxes = m_level_grids;
+
+    // the valid cells of each local box one after the other
+    std::vector<long long> offsets;
+    long long num_values = 0;
+    DataIterator dit = m_state_new.dataIterator();
+    for (dit.begin(); dit.ok(); ++dit)
+    {
+        offsets.push_back(num_values);
+        num_values += m_grids[dit].numPts() * NUM_VARS;
+    }
+    a_level.data.resize(num_values);
+
+    const int nbox = dit.size();
+#pragma omp parallel for default(shared)
+    for (int ibox = 0; ibox < nbox; ++ibox)
+    {
+        const DataIndex &di = dit[ibox];
+        const Box &box = m_grids[di];
+        FArrayBox stored(box, NUM_VARS, a_level.data.data() + offsets[ibox]);
+        stored.copy(m_state_new[di], box);
+    }
+}
+
+void GRAMRLevel::readMemoryCheckpointLevel(
+    const MemoryCheckpoint::level_t &a_level)
+{
+    CH_TIME("GRAMRLevel::readMemoryCheckpointLevel");
+
+    // load balancing is deterministic so the same grids are assigned to the
+    // same ranks as when the checkpoint was written
+    bool same_grids = (a_level.boxes.size() == m_level_grids.size());
+    for (int ibox = 0; same_grids && ibox < m_level_grids.size(); ++ibox)
+        same_grids = (a_level.boxes[ibox] == m_level_grids[ibox]);
+    if (!same_grids || !m_state_new.isDefined())
+        regrid(a_level.boxes);
+    else
+    {
+        // the coarser level may have been regridded back to other grids so
+        // redefine the coarse-fine operators if needed
+        defineLevelOperators(m_grids);
+    }
+
+    m_time = a_level.time;
+    // keep dt consistent with the current dt_multiplier (which a nan rollback
+    // may have reduced since the checkpoint)
+    m_dt = a_level.dt * m_p.dt_multiplier / a_level.dt_multiplier;
+
+    std::vector<long long> offsets;
+    long long num_values = 0;
+    DataIterator dit = m_state_new.dataIterator();
+    for (dit.begin(); dit.ok(); ++dit)
+    {
+        offsets.push_back(num_values);
+        num_values += m_grids[dit].numPts() * NUM_VARS;
+    }
+    if (num_values != a_level.data.size())
+    {
+        MayDay::Error("GRAMRLevel::readMemoryCheckpointLevel: the checkpoint "
+                      "data does not match the grids on this rank");
+    }
+
+    const int nbox = dit.size();
+#pragma omp parallel for default(shared)
+    for (int ibox = 0; ibox < nbox; ++ibox)
+    {
+        const DataIndex &di = dit[ibox];
+        const Box &box = m_grids[di];
+        Real *values = const_cast<Real *>(a_level.data.data()) + offsets[ibox];
+        const FArrayBox stored(box, NUM_VARS, values);
+        m_state_new[di].copy(stored, box);
+    }
+}
+
+bool GRAMRLevel::hasNaNs(double a_max_abs) const
+{
+    CH_TIME("GRAMRLevel::hasNaNs");
+
+    bool found_nan = false;
+    DataIterator dit = m_state_new.dataIterator();
+    const int nbox = dit.size();
+#pragma omp parallel for default(shared) reduction(|| : found_nan)
+    for (int ibox = 0; ibox < nbox; ++ibox)
+    {
+        const DataIndex &di = dit[ibox];
+        const FArrayBox &state = m_state_new[di];
+        BoxIterator bit(m_grids[di]);
+        for (bit.begin(); bit.ok() && !found_nan; ++bit)
+        {
+            for (int comp = 0; comp < NUM_VARS; ++comp)
+            {
+                const Real val = state(bit(), comp);
+                if (std::isnan(val) || std::abs(val) > a_max_abs)
+                {
+                    found_nan = true;
+                    break;
+                }
+            }
+        }
+    }
+    return found_nan;
+}
+
+void GRAMRLevel::applyNaNRemedy(double a_dt_factor, double a_sigma_factor)
+{
+    // dt itself follows when the level is restored from a snapshot
+    m_p.dt_multiplier *= a_dt_factor;
+    // stability requires sigma <= 2 / dt_multiplier (see Alcubierre p344)
+    m_p.sigma = std::min(m_p.sigma * a_sigma_factor, 2. / m_p.dt_multiplier);
+
+    if (m_level == 0)
+    {
+        pout() << "GRAMRLevel::applyNaNRemedy: dt_multiplier = "
+               << m_p.dt_multiplier << ", sigma = " << m_p.sigma << endl;
+    }
+}
+
 // write checkpoint header
 #ifdef CH_USE_HDF5
 void GRAMRLevel::writeCheckpointHeader(HDF5Handle &a_handle) const
@@ -465,6 +1235,25 @@ void GRAMRLevel::writeCheckpointHeader(HDF5Handle &a_handle) const
         sprintf(comp_str, "component_%d", comp);
         header.m_string[comp_str] = UserVariables::variable_names[comp];
     }
+
+    // write out any buffered small data output up to this time and record
+    // how long each file is so that a restart can truncate them to here
+    m_gr_amr.finish_diagnostics();
+    const std::map<std::string, long long> file_sizes =
+        SmallDataIOBuffer::get_file_sizes();
+    if (!file_sizes.empty())
+    {
+        header.m_int["num_small_data_files"] = file_sizes.size();
+        int ifile = 0;
+        for (const auto &file_size : file_sizes)
+        {
+            const std::string ifile_str = std::to_string(ifile++);
+            header.m_string["small_data_file_" + ifile_str] = file_size.first;
+            // (a double is exact for any realistic size)
+            header.m_real["small_data_file_size_" + ifile_str] =
+                file_size.second;
+        }
+    }
     header.writeToFile(a_handle);
 
     if (m_verbosity)
@@ -478,6 +1267,12 @@ void GRAMRLevel::writeCheckpointLevel(HDF5Handle &a_handle) const
     if (m_verbosity)
         pout() << "GRAMRLevel::writeCheckpointLevel" << endl;
 
+    const auto start_time = std::chrono::steady_clock::now();
+
+    // make sure any diagnostics output up to this time is complete so that
+    // it is consistent with the checkpoint
+    m_gr_amr.finish_diagnostics();
+
     char level_str[20];
     sprintf(level_str, "%d", m_level);
     const std::string label = std::string("level_") + level_str;
@@ -517,6 +1312,12 @@ void GRAMRLevel::writeCheckpointLevel(HDF5Handle &a_handle) const
         ghost_vector = m_num_ghosts * IntVect::Unit;
     }
     write(a_handle, m_state_new, "data", ghost_vector);
+
+    // so that the run can stop in time to write a checkpoint
+    m_gr_amr.m_walltime_monitor.add_checkpoint_time(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                      start_time)
+            .count());
 }
 
 void GRAMRLevel::readCheckpointHeader(HDF5Handle &a_handle)
@@ -571,6 +1372,23 @@ void GRAMRLevel::readCheckpointHeader(HDF5Handle &a_handle)
                               "checkpoint does not match solver");
         }
     }
+
+    // truncate the small data files written with buffering to the checkpoint
+    // (instead of removing the duplicate time data from them)
+    if (header.m_int.find("num_small_data_files") != header.m_int.end())
+    {
+        std::map<std::string, long long> file_sizes;
+        const int num_files = header.m_int["num_small_data_files"];
+        for (int ifile = 0; ifile < num_files; ++ifile)
+        {
+            const std::string ifile_str = std::to_string(ifile);
+            const double size = header.m_real["small_data_file_size_" +
+                                              ifile_str];
+            file_sizes[header.m_string["small_data_file_" + ifile_str]] =
+                std::llround(size);
+        }
+        SmallDataIOBuffer::truncate_files(file_sizes);
+    }
 }
 
 void GRAMRLevel::readCheckpointLevel(HDF5Handle &a_handle)
@@ -657,14 +1475,30 @@ void GRAMRLevel::readCheckpointLevel(HDF5Handle &a_handle)
     m_problem_domain = ProblemDomain(domainBox, isPeriodic);
 
     // read grids
-    Vector<Box> grids;
-    const int grid_status = read(a_handle, grids);
+    Vector<Box> file_grids;
+    const int grid_status = read(a_handle, file_grids);
     if (grid_status != 0)
     {
         MayDay::Error("GRAMRLevel::readCheckpointLevel: file does not contain "
                       "a Vector<Box>");
     }
 
+    // split the boxes of the checkpoint if requested so that the data can be
+    // balanced over more ranks than there are boxes in the file
+    Vector<Box> grids;
+    if (m_p.restart_max_box_size > 0)
+    {
+        for (int ibox = 0; ibox < file_grids.size(); ++ibox)
+        {
+            Vector<Box> split_boxes;
+            domainSplit(file_grids[ibox], split_boxes, m_p.restart_max_box_size,
+                        m_p.block_factor);
+            grids.append(split_boxes);
+        }
+    }
+    else
+        grids = file_grids;
+
     // create level domain
     const DisjointBoxLayout level_domain = m_grids = loadBalance(grids);
 
@@ -683,42 +1517,73 @@ void GRAMRLevel::readCheckpointLevel(HDF5Handle &a_handle)
 
     // maintain interlevel stuff
     IntVect iv_ghosts = m_num_ghosts * IntVect::Unit;
+    IntVect iv_state_ghosts = m_num_state_ghosts * IntVect::Unit;
 
-    defineExchangeCopier(level_domain);
-    m_coarse_average.define(level_domain, NUM_VARS, m_ref_ratio);
-    m_fine_interp.define(level_domain, NUM_VARS, m_ref_ratio, m_problem_domain);
+    defineLevelOperators(level_domain);
 
-    if (m_coarser_level_ptr != nullptr)
+    // reshape state with new grids
+    m_state_new.define(level_domain, NUM_VARS, iv_state_ghosts,
+                       *m_data_factory);
+    bool redefine_data = false;
+    Interval comps(0, NUM_VARS - 1);
+    // the boundary ghosts are written too if there are non periodic BCs
+    IntVect ghost_vector = IntVect::Zero;
+    if (m_p.boundary_params.nonperiodic_boundaries_exist)
+        ghost_vector = m_num_ghosts * IntVect::Unit;
+    int data_status;
+    if (grids.size() == file_grids.size())
     {
-        GRAMRLevel *coarser_gr_amr_level_ptr = gr_cast(m_coarser_level_ptr);
-        m_patcher.define(level_domain, coarser_gr_amr_level_ptr->m_grids,
-                         NUM_VARS, coarser_gr_amr_level_ptr->problemDomain(),
-                         m_ref_ratio, m_num_ghosts);
-        if (NUM_DIAGNOSTIC_VARS > 0)
+        data_status = read<FArrayBox>(a_handle, m_state_new, "data",
+                                      level_domain, comps, redefine_data);
+    }
+    else
+    {
+        // each rank reads the boxes of the file assigned to it by balancing
+        // them over all the ranks and the data is then copied onto the split
+        // boxes
+        const DisjointBoxLayout file_domain = loadBalance(file_grids);
+        LevelData<FArrayBox> file_state(file_domain, NUM_VARS, ghost_vector,
+                                        *m_data_factory);
+        data_status = read<FArrayBox>(a_handle, file_state, "data",
+                                      file_domain, comps, redefine_data);
+        if (data_status == 0 && ghost_vector == IntVect::Zero)
+            file_state.copyTo(comps, m_state_new, comps);
+        else if (data_status == 0)
         {
-            m_patcher_diagnostics.define(
-                level_domain, coarser_gr_amr_level_ptr->m_grids,
-                NUM_DIAGNOSTIC_VARS, coarser_gr_amr_level_ptr->problemDomain(),
-                m_ref_ratio, m_num_ghosts);
+            // The boundary ghosts hold evolved data (e.g. with Sommerfeld
+            // boundaries) so copy them too by copying between the layouts
+            // with the boxes extended across the boundaries
+            ProblemDomain grown_domain;
+            const DisjointBoxLayout extended_file_domain = extend_to_boundary(
+                file_domain, m_problem_domain, ghost_vector, grown_domain);
+            const DisjointBoxLayout extended_level_domain = extend_to_boundary(
+                level_domain, m_problem_domain, ghost_vector, grown_domain);
+            LevelData<FArrayBox> extended_file_state(
+                extended_file_domain, NUM_VARS, IntVect::Zero, *m_data_factory);
+            LevelData<FArrayBox> extended_state(
+                extended_level_domain, NUM_VARS, IntVect::Zero,
+                *m_data_factory);
+            copy_matching_boxes(file_state, extended_file_state);
+            extended_file_state.copyTo(comps, extended_state, comps);
+            copy_matching_boxes(extended_state, m_state_new);
+        }
+        if (m_verbosity)
+        {
+            pout() << "split " << file_grids.size() << " boxes into "
+                   << grids.size() << endl;
         }
     }
-
-    // reshape state with new grids
-    m_state_new.define(level_domain, NUM_VARS, iv_ghosts);
-    bool redefine_data = false;
-    Interval comps(0, NUM_VARS - 1);
-    const int data_status = read<FArrayBox>(a_handle, m_state_new, "data",
-                                            level_domain, comps, redefine_data);
     if (data_status != 0)
     {
         MayDay::Error("GRAMRLevel::readCheckpointLevel: file does not contain "
                       "state data");
     }
-    m_state_old.define(level_domain, NUM_VARS, iv_ghosts);
+    m_state_old.define(level_domain, NUM_VARS, iv_state_ghosts,
+                       *m_data_factory);
     if (NUM_DIAGNOSTIC_VARS > 0)
     {
         m_state_diagnostics.define(level_domain, NUM_DIAGNOSTIC_VARS,
-                                   iv_ghosts);
+                                   iv_ghosts, *m_data_factory);
     }
 }
 
@@ -727,6 +1592,10 @@ void GRAMRLevel::writePlotLevel(HDF5Handle &a_handle) const
     if (m_verbosity)
         pout() << "GRAMRLevel::writePlotLevel" << endl;
 
+    // prePlotLevel has been called on every level by now
+    if (m_level == m_gr_amr.get_finest_level())
+        m_gr_amr.run_in_situ_analyses(true);
+
     // number and index of states to print
     const std::vector<std::pair<int, VariableType>> &plot_states =
         m_p.plot_vars;
@@ -741,15 +1610,24 @@ void GRAMRLevel::writePlotLevel(HDF5Handle &a_handle) const
 
         a_handle.setGroup(label);
 
+        // The level is written with coarsen_factor times its dx so the
+        // ratio to the next level changes too
+        const int coarsen_factor = m_p.plot_coarsen_factors[m_level];
+        const int finer_coarsen_factor =
+            (m_level < m_p.max_level) ? m_p.plot_coarsen_factors[m_level + 1]
+                                      : coarsen_factor;
+
         // Setup the level header information
         HDF5HeaderData header;
 
-        header.m_int["ref_ratio"] = m_ref_ratio;
+        header.m_int["ref_ratio"] =
+            m_ref_ratio * coarsen_factor / finer_coarsen_factor;
         header.m_int["tag_buffer_size"] = m_p.tag_buffer_size;
-        header.m_real["dx"] = m_dx;
+        header.m_real["dx"] = m_dx * coarsen_factor;
         header.m_real["dt"] = m_dt;
         header.m_real["time"] = m_time;
-        header.m_box["prob_domain"] = m_problem_domain.domainBox();
+        header.m_box["prob_domain"] =
+            coarsen(m_problem_domain.domainBox(), coarsen_factor);
 
         // Setup the periodicity info
         for (int dir = 0; dir < SpaceDim; ++dir)
@@ -829,6 +1707,21 @@ void GRAMRLevel::writePlotLevel(HDF5Handle &a_handle) const
             }
         }
 
+        if (coarsen_factor > 1)
+        {
+            // (no ghosts are written so there is no need to exchange)
+            DisjointBoxLayout coarse_grids;
+            coarsen(coarse_grids, levelGrids, coarsen_factor);
+            LevelData<FArrayBox> coarse_plot_data(coarse_grids, num_states,
+                                                  IntVect::Zero);
+            coarsenPlotData(coarse_plot_data, plot_data, coarsen_factor);
+
+            // Write the data for this level
+            write(a_handle, coarse_grids);
+            write(a_handle, coarse_plot_data, "data", IntVect::Zero);
+            return;
+        }
+
         plot_data.exchange(plot_data.interval());
 
         // Write the data for this level
@@ -837,6 +1730,41 @@ void GRAMRLevel::writePlotLevel(HDF5Handle &a_handle) const
     }
 }
 
+void GRAMRLevel::coarsenPlotData(LevelData<FArrayBox> &a_coarse_data,
+                                 const LevelData<FArrayBox> &a_data,
+                                 int a_coarsen_factor) const
+{
+    CH_TIME("GRAMRLevel::coarsenPlotData");
+    if (m_p.plot_coarsen_average)
+    {
+        CoarseAverage averager(a_data.disjointBoxLayout(), a_data.nComp(),
+                               a_coarsen_factor);
+        averager.averageToCoarse(a_coarse_data, a_data);
+        return;
+    }
+
+    // keep the first of every a_coarsen_factor cells in each direction (the
+    // coarse grids are the fine grids coarsened so the boxes are local)
+    const DisjointBoxLayout &coarse_grids = a_coarse_data.disjointBoxLayout();
+    DataIterator dit = coarse_grids.dataIterator();
+    const int nbox = dit.size();
+#pragma omp parallel for default(shared)
+    for (int ibox = 0; ibox < nbox; ++ibox)
+    {
+        const DataIndex &di = dit[ibox];
+        FArrayBox &coarse_fab = a_coarse_data[di];
+        const FArrayBox &fab = a_data[di];
+        for (int comp = 0; comp < a_data.nComp(); ++comp)
+        {
+            for (BoxIterator bit(coarse_grids[di]); bit.ok(); ++bit)
+            {
+                const IntVect &iv = bit();
+                coarse_fab(iv, comp) = fab(a_coarsen_factor * iv, comp);
+            }
+        }
+    }
+}
+
 void GRAMRLevel::writePlotHeader(HDF5Handle &a_handle) const
 {
     if (m_verbosity)
@@ -896,7 +1824,14 @@ void GRAMRLevel::evalRHS(GRLevelData &rhs, GRLevelData &soln,
     if (m_verbosity)
         pout() << "GRAMRLevel::evalRHS" << endl;
 
-    soln.exchange(m_exchange_copier);
+    // In deep halo mode, the halo is only exchanged every deep_halo_stages
+    // stages (the first time in advance) and in between the RHS is also
+    // computed in the part of the halo that the following stages need
+    const int deep_halo_stages = m_p.deep_halo_stages;
+    if (deep_halo_stages == 1)
+        soln.exchange(m_exchange_copier);
+    else if (m_rk_stage > 0 && m_rk_stage % deep_halo_stages == 0)
+        soln.exchange(m_halo_exchange_copier);
 
     if (oldCrseSoln.isDefined())
     {
@@ -923,13 +1858,32 @@ void GRAMRLevel::evalRHS(GRLevelData &rhs, GRLevelData &soln,
                 "Time interpolation coefficient is incompatible with RK4.");
         }
 
-        // Interpolate ghost cells from next coarser level in space and time
-        m_patcher.fillInterp(soln, alpha, 0, 0, NUM_VARS);
+        // Interpolate ghost cells from next coarser level in space and time.
+        // The same alpha recurs across the stages and substeps of a coarse
+        // step so (if cache_coarse_fine_ghosts) only interpolate the first
+        // time
+        if (!m_p.cache_coarse_fine_ghosts)
+        {
+            m_patcher.fillInterp(soln, alpha, 0, 0, NUM_VARS);
+        }
+        else if (!m_cf_ghost_cache.fill(soln, alpha))
+        {
+            m_patcher.fillInterp(soln, alpha, 0, 0, NUM_VARS);
+            m_cf_ghost_cache.store(soln, alpha);
+        }
     }
 
     fillBdyGhosts(soln);
 
+    m_rhs_halo_filled = false;
     specificEvalRHS(soln, rhs, time); // Call the problem specific rhs
+    if (deep_halo_stages > 1 && !m_rhs_halo_filled)
+    {
+        MayDay::Error("GRAMRLevel::evalRHS: deep_halo_stages > 1 requires "
+                      "specificEvalRHS to fill get_rhs_ghosts_to_fill() "
+                      "and call mark_rhs_halo_filled()");
+    }
+    ++m_rk_stage;
 
     // evolution of the boundaries according to conditions
     if (m_p.boundary_params.nonperiodic_boundaries_exist)
@@ -945,7 +1899,11 @@ void GRAMRLevel::updateODE(GRLevelData &soln, const GRLevelData &rhs, Real dt)
     CH_TIME("GRAMRLevel::updateODE");
     // m_grown_grids will include outer boundary ghosts in the case of
     // nonperiodic BCs but will just be the problem domain otherwise.
-    soln.plus(rhs, dt, m_grown_grids);
+    // In deep halo mode, the RHS computed in the halo is needed too
+    if (m_p.deep_halo_stages > 1)
+        soln.plus(rhs, dt);
+    else
+        soln.plus(rhs, dt, m_grown_grids);
 
     specificUpdateODE(soln, rhs, dt);
     fillBdyGhosts(soln);
@@ -957,7 +1915,7 @@ void GRAMRLevel::defineSolnData(GRLevelData &newSoln,
                                 const GRLevelData &existingSoln)
 {
     newSoln.define(existingSoln.disjointBoxLayout(), existingSoln.nComp(),
-                   existingSoln.ghostVect());
+                   existingSoln.ghostVect(), *m_data_factory);
 }
 
 // define data holder for RHS based on existingSoln including ghost cell
@@ -965,19 +1923,32 @@ void GRAMRLevel::defineSolnData(GRLevelData &newSoln,
 void GRAMRLevel::defineRHSData(GRLevelData &newRHS,
                                const GRLevelData &existingSoln)
 {
-    // only need ghosts for non periodic boundary case
+    // only need ghosts for non periodic boundary case or for the redundant
+    // computation in deep halo mode
     IntVect ghost_vector = IntVect::Zero;
     if (m_p.boundary_params.nonperiodic_boundaries_exist)
     {
         ghost_vector = m_num_ghosts * IntVect::Unit;
     }
+    else if (m_p.deep_halo_stages > 1)
+    {
+        ghost_vector = (m_num_state_ghosts - m_num_ghosts) * IntVect::Unit;
+    }
     newRHS.define(existingSoln.disjointBoxLayout(), existingSoln.nComp(),
-                  ghost_vector);
+                  ghost_vector, *m_data_factory);
 }
 
 /// copy data in src into dest
 void GRAMRLevel::copySolnData(GRLevelData &dest, const GRLevelData &src)
 {
+    // a threaded local copy (including all ghosts) suffices if the layouts
+    // match; the ghosts are refilled before they are next used anyway
+    if (dest.sameLayout(src) && dest.ghostVect() == src.ghostVect())
+    {
+        dest.copy(src);
+        return;
+    }
+
     src.copyTo(src.interval(), dest, dest.interval());
 
     // Specifically copy boundary cells if non periodic as
@@ -987,6 +1958,17 @@ void GRAMRLevel::copySolnData(GRLevelData &dest, const GRLevelData &src)
 
 double GRAMRLevel::get_dx() const { return m_dx; }
 
+IntVect GRAMRLevel::get_rhs_ghosts_to_fill() const
+{
+    // each stage since the last exchange uses up num_ghosts of the halo
+    const int deep_halo_stages = m_p.deep_halo_stages;
+    const int stages_left =
+        deep_halo_stages - 1 - m_rk_stage % deep_halo_stages;
+    return stages_left * m_num_ghosts * IntVect::Unit;
+}
+
+void GRAMRLevel::mark_rhs_halo_filled() { m_rhs_halo_filled = true; }
+
 bool GRAMRLevel::at_level_timestep_multiple(int a_level) const
 {
     double target_dt = m_p.coarsest_dt;
@@ -999,6 +1981,23 @@ bool GRAMRLevel::at_level_timestep_multiple(int a_level) const
     return (abs(time_remainder) < m_gr_amr.timeEps() * m_p.coarsest_dt);
 }
 
+double GRAMRLevel::get_time_between_regrids() const
+{
+    double level_dt = m_p.coarsest_dt;
+    for (int ilevel = 0; ilevel < m_level; ++ilevel)
+    {
+        level_dt /= m_p.ref_ratios[ilevel];
+    }
+    for (int ilevel = m_level; ilevel >= 0; --ilevel)
+    {
+        if (m_p.regrid_interval[ilevel] > 0)
+            return m_p.regrid_interval[ilevel] * level_dt;
+        if (ilevel > 0)
+            level_dt *= m_p.ref_ratios[ilevel - 1];
+    }
+    return 0.;
+}
+
 void GRAMRLevel::fillAllGhosts(const VariableType var_type,
                                const Interval &a_comps)
 {
@@ -1100,6 +2099,11 @@ void GRAMRLevel::defineExchangeCopier(const DisjointBoxLayout &a_level_grids)
 
     IntVect iv_ghosts = m_num_ghosts * IntVect::Unit;
     m_exchange_copier.exchangeDefine(m_grown_grids, iv_ghosts);
+    if (m_p.deep_halo_stages > 1)
+    {
+        m_halo_exchange_copier.exchangeDefine(
+            m_grown_grids, m_num_state_ghosts * IntVect::Unit);
+    }
 }
 
 void GRAMRLevel::printProgress(const std::string &from) const
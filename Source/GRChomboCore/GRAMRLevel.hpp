@@ -8,6 +8,7 @@
 
 // Chombo includes
 #include "AMRLevel.H"
+#include "BRMeshRefine.H"
 #include "CoarseAverage.H"
 #include "FourthOrderFillPatch.H"
 #include "LevelFluxRegister.H" //We don't actually use flux conservation but Chombo assumes we do
@@ -16,14 +17,23 @@
 
 // Other includes
 #include "BoundaryConditions.hpp"
+#include "CoarseFineGhostCache.hpp"
+#include "DryRunEstimate.hpp"
 #include "GRAMR.hpp"
 #include "GRLevelData.hpp"
+#include "HugePageFArrayBox.hpp"
 #include "InterpSource.hpp"
+#include "MemoryCheckpoint.hpp"
 #include "SimulationParameters.hpp"
+#include "SmallDataIOBuffer.hpp"
 #include "UserVariables.hpp" // need NUM_VARS
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <limits>
+#include <map>
 #include <sys/time.h>
+#include <unordered_map>
 
 // Chombo namespace
 #include "UsingNamespace.H"
@@ -71,6 +81,10 @@ class GRAMRLevel : public AMRLevel, public InterpSource
     /// create tags at initialization
     virtual void tagCellsInit(IntVectSet &a_tags);
 
+    /// things to do once the new grids are known but before regridding
+    virtual void preRegrid(int a_base_level,
+                           const Vector<Vector<Box>> &a_new_grids);
+
     /// regrid
     virtual void regrid(const Vector<Box> &a_new_grids);
 
@@ -91,6 +105,25 @@ class GRAMRLevel : public AMRLevel, public InterpSource
 
     DisjointBoxLayout loadBalance(const Vector<Box> &a_grids);
 
+    /// the number of ranks a_num_boxes boxes are balanced over (fewer than
+    /// a_num_ranks if agglomeration_boxes_per_rank is set)
+    int numLoadBalanceRanks(int a_num_boxes, int a_num_ranks) const;
+
+    /// the rank of each of a_grids if they were balanced over a_num_ranks
+    Vector<int> assignRanks(const Vector<Box> &a_grids, int a_num_ranks) const;
+
+    /// (re)define the exchange copier and the averaging and interpolation
+    /// objects, skipping those whose grids (on this or the coarser level)
+    /// have not changed since they were last defined
+    void defineLevelOperators(const DisjointBoxLayout &a_level_domain);
+
+    /// interpolate m_state_new from the coarser level only on the cells not
+    /// covered by a_old_grids (which are copied from the old data instead).
+    /// a_scratch (on the same grids as m_state_new) may be overwritten
+    void interpToFineUncovered(const Vector<Box> &a_old_grids,
+                               const GRLevelData &a_coarse_state,
+                               GRLevelData &a_scratch);
+
 #ifdef CH_USE_HDF5
     virtual void writeCheckpointHeader(HDF5Handle &a_handle) const;
 
@@ -103,6 +136,13 @@ class GRAMRLevel : public AMRLevel, public InterpSource
     virtual void writePlotHeader(HDF5Handle &a_handle) const;
 
     virtual void writePlotLevel(HDF5Handle &a_handle) const;
+
+    /// Averages or subsamples (if plot_coarsen_average is false) a_data
+    /// onto a_coarse_data (on the grids of a_data coarsened by
+    /// a_coarsen_factor)
+    void coarsenPlotData(LevelData<FArrayBox> &a_coarse_data,
+                         const LevelData<FArrayBox> &a_data,
+                         int a_coarsen_factor) const;
 #endif
 
   public:
@@ -142,6 +182,11 @@ class GRAMRLevel : public AMRLevel, public InterpSource
     /// (Pure) virtual function for the initial data calculation
     virtual void initialData() = 0;
 
+    /// If warm starting, fills the state from the warm start checkpoint
+    /// (and from the coarser level where it does not cover this level) and
+    /// returns true, in which case initialData need not do anything else
+    bool warmStartData();
+
     /// Computes which cells have insufficient resolution and should be tagged
     virtual void computeTaggingCriterion(FArrayBox &tagging_criterion,
                                          const FArrayBox &current_state) = 0;
@@ -167,12 +212,61 @@ class GRAMRLevel : public AMRLevel, public InterpSource
 
     double get_dx() const;
 
+    /// The ghosts of the RHS that specificEvalRHS must fill (i.e. pass to
+    /// BoxLoops::loop): none unless deep_halo_stages > 1, in which case it is
+    /// the part of the halo still needed by the following RK stages
+    IntVect get_rhs_ghosts_to_fill() const;
+
+    /// specificEvalRHS must call this once it has filled the ghosts above
+    /// (which is checked if deep_halo_stages > 1)
+    void mark_rhs_halo_filled();
+
+    /// The current grids (i.e. the region this level covers) split into
+    /// boxes of at most a_max_box_size (that are multiples of block_factor)
+    Vector<Box> splitGrids(int a_max_box_size) const;
+
+    /// Regrids onto splitGrids(a_max_box_size), keeping all the data
+    /// including the boundary ghosts (none of it is interpolated)
+    void resplitGrids(int a_max_box_size);
+
+    /// Returns the time (max over ranks, in seconds) of a ghost fill and RHS
+    /// evaluation on a copy of this level split into boxes of at most
+    /// a_max_box_size, averaged over a_num_trials
+    double timeBoxSizeTrial(int a_max_box_size, int a_num_trials);
+
+    /// Estimates the cells, memory and ghost exchange volume on each rank if
+    /// the current grids of this level were balanced over a_num_ranks (and,
+    /// if a_measure_time, the cost per cell of an RHS evaluation here)
+    DryRunEstimate::level_t estimateDryRun(int a_num_ranks,
+                                           bool a_measure_time);
+
+    /// store the grids, time, dt and (local) state of this level in memory
+    void writeMemoryCheckpointLevel(MemoryCheckpoint::level_t &a_level) const;
+
+    /// restore them, regridding first if the grids have changed (dt is scaled
+    /// by the change in dt_multiplier since they were stored). The coarser
+    /// level must have been restored already.
+    void readMemoryCheckpointLevel(const MemoryCheckpoint::level_t &a_level);
+
+    /// Returns true if any valid cell of the (local) state is a nan or larger
+    /// in magnitude than a_max_abs (as in NanCheck)
+    bool hasNaNs(double a_max_abs = 1e20) const;
+
+    /// Multiply the dt_multiplier by a_dt_factor and sigma by a_sigma_factor
+    /// (capped at the stability limit) before restoring a nan snapshot
+    void applyNaNRemedy(double a_dt_factor, double a_sigma_factor);
+
     /// Returns true if m_time is the same as the time at the end of the current
     /// timestep on level a_level and false otherwise
     /// Useful to check whether to calculate something in postTimeStep (which
     /// might only be needed at the end of a_level's timestep)
     bool at_level_timestep_multiple(int a_level) const;
 
+    /// Returns the time between the regrids that remake the grids tagged on
+    /// this level (i.e. those of this level or the nearest coarser level that
+    /// regrids) or 0 if they are never remade
+    double get_time_between_regrids() const;
+
     /// Fill all [either] evolution or diagnostic ghost cells
     virtual void fillAllGhosts(
         const VariableType var_type = VariableType::evolution,
@@ -223,6 +317,11 @@ class GRAMRLevel : public AMRLevel, public InterpSource
     int m_verbosity;          //!< Level of verbosity of the output
 
     Copier m_exchange_copier; //!< copier (for ghost cells on same level)
+    Copier m_halo_exchange_copier; //!< copier for the whole state halo (only
+                                   //!< used if deep_halo_stages > 1)
+    int m_rk_stage; //!< the RK stage (counting from 0 in each advance)
+    bool m_rhs_halo_filled; //!< whether specificEvalRHS marked the ghosts
+                            //!< of the RHS as filled
 
     CoarseAverage m_coarse_average; //!< Averages from fine to coarse level
 
@@ -231,15 +330,27 @@ class GRAMRLevel : public AMRLevel, public InterpSource
     FourthOrderFillPatch
         m_patcher_diagnostics; //!< Organises interpolation from coarse to
                                //!< fine levels of ghosts for diagnostics
+    CoarseFineGhostCache m_cf_ghost_cache; //!< Reuses the ghosts m_patcher
+                                           //!< interpolates for each RK stage
+                                           //!< (if cache_coarse_fine_ghosts)
     FourthOrderFineInterp m_fine_interp; //!< executes the interpolation from
                                          //!< coarse to fine when regridding
 
     DisjointBoxLayout m_grids;       //!< Holds grid setup (the layout of boxes)
     DisjointBoxLayout m_grown_grids; //!< Holds grown grid setup (for
                                      //!< Sommerfeld BCs)
+    DisjointBoxLayout m_operators_grids; //!< The grids the level operators
+                                         //!< were last defined on
+    DisjointBoxLayout m_operators_coarser_grids; //!< and the coarser grids
+
+    RefCountedPtr<DataFactory<FArrayBox>>
+        m_data_factory; //!< Creates the FArrayBoxes in the GRLevelData
 
   public:
     const int m_num_ghosts; //!< Number of ghost cells
+    const int m_num_state_ghosts; //!< Number of ghost cells of the evolved
+                                  //!< state (m_num_ghosts unless in deep
+                                  //!< halo mode)
 };
 
 #endif /* GRAMRLEVEL_HPP_ */
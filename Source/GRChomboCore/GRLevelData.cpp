@@ -5,110 +5,344 @@
 
 // Chombo includes
 #include "FArrayBox.H"
+#include "MayDay.H"
 
 // Our includes
 #include "GRLevelData.hpp"
 
+// Other includes
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
+
 // Chombo namespace
 #include "UsingNamespace.H"
 
+namespace
+{
+//! Calls a_row_op(ibox, icomp, iv, row_length) for every x-row (starting at
+//! iv) of every region, threading over (box, component, plane in the last
+//! direction) work items so that there is enough work even with few boxes
+template <class row_op_t>
+void for_all_rows(const std::vector<Box> &a_regions, const Interval &a_comps,
+                  const row_op_t &a_row_op)
+{
+    const int last_dir = CH_SPACEDIM - 1;
+    const int num_comps = a_comps.size();
+    const int num_regions = a_regions.size();
+
+    // the work items of region ibox are [offsets[ibox], offsets[ibox + 1])
+    std::vector<long> offsets(num_regions + 1, 0);
+    for (int ibox = 0; ibox < num_regions; ++ibox)
+    {
+        const long num_planes =
+            a_regions[ibox].isEmpty() ? 0 : a_regions[ibox].size(last_dir);
+        offsets[ibox + 1] = offsets[ibox] + num_comps * num_planes;
+    }
+    const long num_items = offsets[num_regions];
+
+#ifdef _OPENMP
+#pragma omp parallel for default(shared) schedule(static)
+#endif
+    for (long item = 0; item < num_items; ++item)
+    {
+        const int ibox =
+            std::upper_bound(offsets.begin(), offsets.end(), item) -
+            offsets.begin() - 1;
+        const Box &region = a_regions[ibox];
+        const long num_planes = region.size(last_dir);
+        const long local_item = item - offsets[ibox];
+        const int icomp = a_comps.begin() + local_item / num_planes;
+        const int row_length = region.size(0);
+
+        IntVect iv = region.smallEnd();
+        iv[last_dir] += local_item % num_planes;
+#if CH_SPACEDIM == 3
+        for (iv[1] = region.smallEnd(1); iv[1] <= region.bigEnd(1); ++iv[1])
+#endif
+        {
+            a_row_op(ibox, icomp, iv, row_length);
+        }
+    }
+}
+
+//! A DataFactory which hands out the given FArrayBoxes (keyed by their box)
+//! rather than allocating new ones where possible
+class MovingDataFactory : public DataFactory<FArrayBox>
+{
+  public:
+    MovingDataFactory(std::map<Box, FArrayBox *> &a_fabs,
+                      const DataFactory<FArrayBox> &a_fallback_factory)
+        : m_fabs(a_fabs), m_fallback_factory(a_fallback_factory)
+    {
+    }
+
+    virtual FArrayBox *create(const Box &a_box, int a_ncomps,
+                              const DataIndex &a_datInd) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_fabs.find(a_box);
+            if (it != m_fabs.end() && it->second->nComp() == a_ncomps)
+            {
+                FArrayBox *fab = it->second;
+                m_fabs.erase(it);
+                return fab;
+            }
+        }
+        return m_fallback_factory.create(a_box, a_ncomps, a_datInd);
+    }
+
+    //! the map is guarded by the mutex so this is as thread safe as the
+    //! fallback factory
+    virtual bool threadSafe() const
+    {
+        return m_fallback_factory.threadSafe();
+    }
+
+  private:
+    std::map<Box, FArrayBox *> &m_fabs;
+    const DataFactory<FArrayBox> &m_fallback_factory;
+    mutable std::mutex m_mutex;
+};
+} // namespace
+
 GRLevelData::GRLevelData() : LevelData<FArrayBox>() {}
 
-void GRLevelData::setVal(const double a_val)
+void GRLevelData::setVal(const double a_val) { setVal(a_val, interval()); }
+
+void GRLevelData::setVal(const double a_val, const int a_comp)
+{
+    setVal(a_val, Interval(a_comp, a_comp));
+}
+
+void GRLevelData::setVal(const double a_val, const Interval a_comps)
 {
+    CH_TIME("GRLevelData::setVal");
+    std::vector<FArrayBox *> fabs;
+    std::vector<Box> regions;
     DataIterator dit = m_disjointBoxLayout.dataIterator();
     for (dit.begin(); dit.ok(); ++dit)
     {
-        FArrayBox &fab = (*this)[dit];
-        fab.setVal(a_val);
+        fabs.push_back(&(*this)[dit]);
+        regions.push_back(fabs.back()->box());
     }
+
+    for_all_rows(regions, a_comps,
+                 [&](int ibox, int icomp, const IntVect &iv, int row_length) {
+                     Real *row = &(*fabs[ibox])(iv, icomp);
+#pragma omp simd
+                     for (int ix = 0; ix < row_length; ++ix)
+                         row[ix] = a_val;
+                 });
 }
 
-void GRLevelData::setVal(const double a_val, const int a_comp)
+void GRLevelData::copy(const GRLevelData &a_src) { copy(a_src, interval()); }
+
+void GRLevelData::copy(const GRLevelData &a_src, const Interval a_comps)
 {
+    CH_TIME("GRLevelData::copy");
+    CH_assert(sameLayout(a_src));
+    std::vector<FArrayBox *> fabs;
+    std::vector<const FArrayBox *> src_fabs;
+    std::vector<Box> regions;
     DataIterator dit = m_disjointBoxLayout.dataIterator();
     for (dit.begin(); dit.ok(); ++dit)
     {
-        FArrayBox &fab = (*this)[dit];
-        fab.setVal(a_val, a_comp);
+        fabs.push_back(&(*this)[dit]);
+        src_fabs.push_back(&a_src[dit]);
+        regions.push_back(fabs.back()->box() & src_fabs.back()->box());
     }
+
+    for_all_rows(regions, a_comps,
+                 [&](int ibox, int icomp, const IntVect &iv, int row_length) {
+                     Real *row = &(*fabs[ibox])(iv, icomp);
+                     const Real *src_row = &(*src_fabs[ibox])(iv, icomp);
+#pragma omp simd
+                     for (int ix = 0; ix < row_length; ++ix)
+                         row[ix] = src_row[ix];
+                 });
 }
 
-void GRLevelData::setVal(const double a_val, const Interval a_comps)
+void GRLevelData::scale(const double a_scale)
 {
+    CH_TIME("GRLevelData::scale");
+    std::vector<FArrayBox *> fabs;
+    std::vector<Box> regions;
     DataIterator dit = m_disjointBoxLayout.dataIterator();
-    // Want component loop inside so unfortunately we have to duplicate the
-    // outer loop
     for (dit.begin(); dit.ok(); ++dit)
     {
-        FArrayBox &fab = (*this)[dit];
-        for (int i = a_comps.begin(); i <= a_comps.end(); ++i)
-        {
-            fab.setVal(a_val, i);
-        }
+        fabs.push_back(&(*this)[dit]);
+        regions.push_back(fabs.back()->box());
     }
+
+    for_all_rows(regions, interval(),
+                 [&](int ibox, int icomp, const IntVect &iv, int row_length) {
+                     Real *row = &(*fabs[ibox])(iv, icomp);
+#pragma omp simd
+                     for (int ix = 0; ix < row_length; ++ix)
+                         row[ix] *= a_scale;
+                 });
+}
+
+void GRLevelData::plus(const GRLevelData &a_src, const double a_scale)
+{
+    CH_TIME("GRLevelData::plus");
+    CH_assert(sameLayout(a_src));
+    std::vector<FArrayBox *> fabs;
+    std::vector<const FArrayBox *> src_fabs;
+    std::vector<Box> regions;
+    DataIterator dit = m_disjointBoxLayout.dataIterator();
+    for (dit.begin(); dit.ok(); ++dit)
+    {
+        fabs.push_back(&(*this)[dit]);
+        src_fabs.push_back(&a_src[dit]);
+        regions.push_back(fabs.back()->box() & src_fabs.back()->box());
+    }
+
+    for_all_rows(regions, interval(),
+                 [&](int ibox, int icomp, const IntVect &iv, int row_length) {
+                     Real *row = &(*fabs[ibox])(iv, icomp);
+                     const Real *src_row = &(*src_fabs[ibox])(iv, icomp);
+#pragma omp simd
+                     for (int ix = 0; ix < row_length; ++ix)
+                         row[ix] += a_scale * src_row[ix];
+                 });
 }
 
 void GRLevelData::plus(const GRLevelData &a_src, const double a_scale,
                        const DisjointBoxLayout &a_disjoint_box_layout)
 {
     CH_TIME("GRLevelData::plus");
+    CH_assert(nComp() == a_src.nComp());
+    std::vector<FArrayBox *> fabs;
+    std::vector<const FArrayBox *> src_fabs;
+    std::vector<Box> regions;
     DataIterator dit = a_disjoint_box_layout.dataIterator();
     for (dit.begin(); dit.ok(); ++dit)
     {
-        FArrayBox &fab = (*this)[dit];
-        const FArrayBox &src_fab = a_src[dit];
-        Real *fab_data = fab.dataPtr();
-        const Real *const src_fab_data = src_fab.dataPtr();
-
-        const Box &this_box = fab.box();
-        const Box &src_box = src_fab.box();
-        const Box loop_box = a_disjoint_box_layout[dit];
-        const int *this_lo = this_box.loVect();
-        const int *src_lo = src_box.loVect();
-        const int *loop_lo = loop_box.loVect();
-        const int *loop_hi = loop_box.hiVect();
-        const IntVect &this_size = this_box.size();
-        const IntVect &src_size = src_box.size();
-        const int num_comps = fab.nComp();
-
-        CH_assert(num_comps == src_fab.nComp());
-#ifdef _OPENMP
-#pragma omp parallel for default(shared) collapse(CH_SPACEDIM)
-#endif
-        for (int icomp = 0; icomp < num_comps; ++icomp)
-#if CH_SPACEDIM == 3
-            for (int iz = loop_lo[2]; iz <= loop_hi[2]; ++iz)
-#endif
-                for (int iy = loop_lo[1]; iy <= loop_hi[1]; ++iy)
-                {
+        fabs.push_back(&(*this)[dit]);
+        src_fabs.push_back(&a_src[dit]);
+        regions.push_back(a_disjoint_box_layout[dit]);
+    }
+
+    for_all_rows(regions, interval(),
+                 [&](int ibox, int icomp, const IntVect &iv, int row_length) {
+                     Real *row = &(*fabs[ibox])(iv, icomp);
+                     const Real *src_row = &(*src_fabs[ibox])(iv, icomp);
 #pragma omp simd
-                    for (int ix = loop_lo[0]; ix <= loop_hi[0]; ++ix)
-                    {
-                        const int this_index =
-                            ix - this_lo[0] + (iy - this_lo[1]) * this_size[0] +
-#if CH_SPACEDIM == 3
-                            (iz - this_lo[2]) * this_size[0] * this_size[1] +
-#endif
-                            icomp * this_size[0] * this_size[1]
-#if CH_SPACEDIM == 3
-                                * this_size[2]
-#endif
-                            ;
-                        const int src_index =
-                            ix - src_lo[0] + (iy - src_lo[1]) * src_size[0] +
-#if CH_SPACEDIM == 3
-                            (iz - src_lo[2]) * src_size[0] * src_size[1] +
-#endif
-                            icomp * src_size[0] * src_size[1]
-#if CH_SPACEDIM == 3
-                                * src_size[2]
-#endif
-                            ;
-                        fab_data[this_index] +=
-                            a_scale * src_fab_data[src_index];
-                    }
-                }
+                     for (int ix = 0; ix < row_length; ++ix)
+                         row[ix] += a_scale * src_row[ix];
+                 });
+}
+
+void GRLevelData::lincomb(const double a_a, const GRLevelData &a_x,
+                          const double a_b, const GRLevelData &a_y)
+{
+    CH_TIME("GRLevelData::lincomb");
+    CH_assert(sameLayout(a_x) && sameLayout(a_y));
+    std::vector<FArrayBox *> fabs;
+    std::vector<const FArrayBox *> x_fabs, y_fabs;
+    std::vector<Box> regions;
+    DataIterator dit = m_disjointBoxLayout.dataIterator();
+    for (dit.begin(); dit.ok(); ++dit)
+    {
+        fabs.push_back(&(*this)[dit]);
+        x_fabs.push_back(&a_x[dit]);
+        y_fabs.push_back(&a_y[dit]);
+        regions.push_back(fabs.back()->box() & x_fabs.back()->box() &
+                          y_fabs.back()->box());
+    }
+
+    for_all_rows(regions, interval(),
+                 [&](int ibox, int icomp, const IntVect &iv, int row_length) {
+                     Real *row = &(*fabs[ibox])(iv, icomp);
+                     const Real *x_row = &(*x_fabs[ibox])(iv, icomp);
+                     const Real *y_row = &(*y_fabs[ibox])(iv, icomp);
+#pragma omp simd
+                     for (int ix = 0; ix < row_length; ++ix)
+                         row[ix] = a_a * x_row[ix] + a_b * y_row[ix];
+                 });
+}
+
+bool GRLevelData::sameLayout(const GRLevelData &a_other) const
+{
+    return (m_disjointBoxLayout == a_other.disjointBoxLayout()) &&
+           (nComp() == a_other.nComp());
+}
+
+void GRLevelData::swap(GRLevelData &a_other)
+{
+    if (!sameLayout(a_other) || ghostVect() != a_other.ghostVect())
+        MayDay::Error("GRLevelData::swap: the layouts or ghosts differ");
+    DataIterator dit = m_disjointBoxLayout.dataIterator();
+    for (dit.begin(); dit.ok(); ++dit)
+    {
+        const int ind = dit().datInd();
+        std::swap(m_vector[ind], a_other.m_vector[ind]);
+    }
+}
+
+void GRLevelData::defineFrom(GRLevelData &a_src,
+                             const DisjointBoxLayout &a_layout,
+                             const DataFactory<FArrayBox> &a_factory)
+{
+    CH_TIME("GRLevelData::defineFrom");
+    CH_assert(this != &a_src);
+    const DisjointBoxLayout &src_layout = a_src.disjointBoxLayout();
+
+    // Work out (on every rank) which boxes are unchanged and on the same rank
+    std::map<Box, int> new_box_procs;
+    LayoutIterator lit = a_layout.layoutIterator();
+    for (lit.begin(); lit.ok(); ++lit)
+        new_box_procs[a_layout[lit]] = a_layout.procID(lit());
+
+    Vector<Box> changed_boxes;
+    Vector<int> changed_procs;
+    LayoutIterator src_lit = src_layout.layoutIterator();
+    for (src_lit.begin(); src_lit.ok(); ++src_lit)
+    {
+        const Box &box = src_layout[src_lit];
+        const int proc = src_layout.procID(src_lit());
+        auto it = new_box_procs.find(box);
+        if (it == new_box_procs.end() || it->second != proc)
+        {
+            changed_boxes.push_back(box);
+            changed_procs.push_back(proc);
+        }
+    }
+
+    // Take the FArrayBoxes out of a_src
+    std::map<Box, FArrayBox *> unchanged_fabs, changed_fabs;
+    DataIterator dit = src_layout.dataIterator();
+    for (dit.begin(); dit.ok(); ++dit)
+    {
+        FArrayBox *&fab_ptr = a_src.m_vector[dit().datInd()];
+        auto it = new_box_procs.find(src_layout[dit]);
+        if (it != new_box_procs.end() && it->second == procID())
+            unchanged_fabs[fab_ptr->box()] = fab_ptr;
+        else
+            changed_fabs[fab_ptr->box()] = fab_ptr;
+        fab_ptr = nullptr;
+    }
+
+    // Define this, moving the unchanged FArrayBoxes
+    MovingDataFactory unchanged_factory(unchanged_fabs, a_factory);
+    define(a_layout, a_src.nComp(), a_src.ghostVect(), unchanged_factory);
+    CH_assert(unchanged_fabs.empty());
+
+    // and copy the valid cells from the rest
+    if (changed_boxes.size() > 0)
+    {
+        DisjointBoxLayout changed_layout(changed_boxes, changed_procs,
+                                         src_layout.physDomain());
+        changed_layout.close();
+        GRLevelData changed_data;
+        MovingDataFactory changed_factory(changed_fabs, a_factory);
+        changed_data.define(changed_layout, a_src.nComp(), a_src.ghostVect(),
+                            changed_factory);
+        changed_data.copyTo(changed_data.interval(), *this, interval());
     }
 }
 
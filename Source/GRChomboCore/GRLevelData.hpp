@@ -13,6 +13,13 @@
 // Chombo namespace
 #include "UsingNamespace.H"
 
+/// LevelData<FArrayBox> with threaded bulk operations
+/**
+ * The bulk operations below are parallelised with OpenMP over (box,
+ * component, plane in the last direction) work items, with the innermost
+ * x-rows vectorised. Unless stated otherwise they act on the whole FArrayBox
+ * including ghost cells and the arguments must share the same layout.
+ */
 class GRLevelData : public LevelData<FArrayBox>
 {
   public:
@@ -24,9 +31,40 @@ class GRLevelData : public LevelData<FArrayBox>
 
     void setVal(const double a_val, const Interval a_comps);
 
+    //! Copies a_src into this (a local copy, no communication)
+    void copy(const GRLevelData &a_src);
+
+    void copy(const GRLevelData &a_src, const Interval a_comps);
+
+    //! Multiplies this by a_scale
+    void scale(const double a_scale);
+
+    //! this += a_scale * a_src
+    void plus(const GRLevelData &a_src, const double a_scale);
+
     // loop only goes over a_disjoint_box_layout
     void plus(const GRLevelData &a_src, const double a_scale,
               const DisjointBoxLayout &a_disjoint_box_layout);
+
+    //! this = a_a * a_x + a_b * a_y
+    void lincomb(const double a_a, const GRLevelData &a_x, const double a_b,
+                 const GRLevelData &a_y);
+
+    //! Returns true if a_other has the same layout as this (so the above
+    //! operations can be used instead of copyTo)
+    bool sameLayout(const GRLevelData &a_other) const;
+
+    //! Swaps the data of this and a_other (which must have the same layout
+    //! and ghosts, an error otherwise) without copying
+    void swap(GRLevelData &a_other);
+
+    //! Defines this on a_layout with the components and ghosts of a_src and
+    //! fills the valid cells from a_src (like copyTo). The FArrayBoxes of
+    //! boxes which are unchanged and stay on the same rank are moved rather
+    //! than copied so only the changed boxes are allocated and transferred.
+    //! a_src is left without data and must be redefined before it is used.
+    void defineFrom(GRLevelData &a_src, const DisjointBoxLayout &a_layout,
+                    const DataFactory<FArrayBox> &a_factory);
 };
 
 #endif /* GRLEVELDATA_HPP_ */
@@ -0,0 +1,59 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+// Chombo includes
+#include "MayDay.H"
+
+// Our includes
+#include "HugePageFArrayBox.hpp"
+
+// Other includes
+#include <cstdlib>
+#include <sys/mman.h>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+HugePageFArrayBox::HugePageFArrayBox(const Box &a_box, int a_ncomp)
+    : FArrayBox(a_box, a_ncomp, allocate(a_box, a_ncomp))
+{
+    m_huge_page_data = dataPtr();
+}
+
+HugePageFArrayBox::~HugePageFArrayBox() { std::free(m_huge_page_data); }
+
+Real *HugePageFArrayBox::allocate(const Box &a_box, int a_ncomp)
+{
+    const std::size_t bytes = static_cast<std::size_t>(a_box.numPts()) *
+                              static_cast<std::size_t>(a_ncomp) * sizeof(Real);
+    if (bytes == 0)
+        return nullptr;
+
+    // small boxes would waste most of a huge page so just align these to a
+    // cache line
+    if (bytes < s_huge_page_size)
+    {
+        void *ptr = nullptr;
+        if (posix_memalign(&ptr, 64, bytes) != 0)
+            MayDay::Error("HugePageFArrayBox::allocate: posix_memalign failed");
+        return static_cast<Real *>(ptr);
+    }
+
+    // round up to a whole number of huge pages so that the final page is not
+    // shared with other (non huge page) allocations
+    const std::size_t alloc_bytes =
+        ((bytes + s_huge_page_size - 1) / s_huge_page_size) * s_huge_page_size;
+
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, s_huge_page_size, alloc_bytes) != 0)
+        MayDay::Error("HugePageFArrayBox::allocate: posix_memalign failed");
+
+#ifdef MADV_HUGEPAGE
+    // failure just means we fall back to normal pages
+    madvise(ptr, alloc_bytes, MADV_HUGEPAGE);
+#endif
+
+    return static_cast<Real *>(ptr);
+}
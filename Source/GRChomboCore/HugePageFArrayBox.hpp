@@ -0,0 +1,60 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef HUGEPAGEFARRAYBOX_HPP_
+#define HUGEPAGEFARRAYBOX_HPP_
+
+// Chombo includes
+#include "BoxLayoutData.H"
+#include "FArrayBox.H"
+
+// Other includes
+#include <cstddef>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+/// An FArrayBox whose data is backed by transparent huge pages
+/**
+ * If the data spans at least one huge page, it is allocated with 2MB alignment
+ * and the kernel is asked to back it with huge pages via
+ * madvise(MADV_HUGEPAGE). The FArrayBox itself only aliases this memory so
+ * everything else behaves as normal. On systems without MADV_HUGEPAGE this
+ * just gives an aligned allocation.
+ */
+class HugePageFArrayBox : public FArrayBox
+{
+  public:
+    //! The huge page size requested from the kernel (2MB)
+    static const std::size_t s_huge_page_size = 2 * 1024 * 1024;
+
+    HugePageFArrayBox(const Box &a_box, int a_ncomp);
+
+    virtual ~HugePageFArrayBox();
+
+  protected:
+    Real *m_huge_page_data; //!< the memory that the FArrayBox aliases
+
+    //! Allocates the (possibly huge page backed) memory for a_box x a_ncomp
+    static Real *allocate(const Box &a_box, int a_ncomp);
+
+  private:
+    // The memory is owned by this object so disallow copying
+    HugePageFArrayBox(const HugePageFArrayBox &) = delete;
+    HugePageFArrayBox &operator=(const HugePageFArrayBox &) = delete;
+};
+
+/// DataFactory to pass to LevelData::define so that it uses HugePageFArrayBox
+class HugePageDataFactory : public DataFactory<FArrayBox>
+{
+  public:
+    virtual FArrayBox *create(const Box &a_box, int a_ncomps,
+                              const DataIndex &a_datInd) const
+    {
+        return new HugePageFArrayBox(a_box, a_ncomps);
+    }
+};
+
+#endif /* HUGEPAGEFARRAYBOX_HPP_ */
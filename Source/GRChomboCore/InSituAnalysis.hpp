@@ -0,0 +1,54 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef INSITUANALYSIS_HPP_
+#define INSITUANALYSIS_HPP_
+
+// Chombo includes
+#include "DisjointBoxLayout.H"
+
+// Our includes
+#include "GRLevelData.hpp"
+
+// Other includes
+#include <functional>
+#include <vector>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+/// The hierarchy as handed to an in-situ analysis (see
+/// GRAMR::add_in_situ_analysis)
+/**
+ * Nothing is copied: the pointers refer to the data of the levels and are
+ * only valid during the call. Every rank is called with its local boxes, so
+ * any result must be reduced across ranks by the analysis itself.
+ */
+struct InSituData
+{
+    struct level_t
+    {
+        int level;
+        double dx;
+        int ref_ratio; //!< to the next finer level
+        const DisjointBoxLayout *grids;
+        const GRLevelData *state; //!< the evolution variables
+        //! the diagnostic variables as last computed (e.g. in prePlotLevel)
+        //! or nullptr if there are none
+        const GRLevelData *diagnostics;
+    };
+
+    double time;
+    double dt;    //!< the coarsest level timestep
+    int step;     //!< the coarse step
+    bool at_plot; //!< called when writing plot files (rather than after a
+                  //!< coarse step)
+    std::vector<level_t> levels; //!< from the coarsest to the finest
+};
+
+//! An analysis called with the hierarchy (collectively on all ranks)
+using InSituAnalysis = std::function<void(const InSituData &)>;
+
+#endif /* INSITUANALYSIS_HPP_ */
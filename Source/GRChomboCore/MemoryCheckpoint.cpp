@@ -0,0 +1,93 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+// Chombo includes
+#include "CH_Timer.H"
+#include "SPMD.H"
+
+// Our includes
+#include "MemoryCheckpoint.hpp"
+
+// Other includes
+#include <algorithm>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+void MemoryCheckpoint::exchange_with_buddy()
+{
+    CH_TIME("MemoryCheckpoint::exchange_with_buddy");
+    for (level_t &level : levels)
+        shift_data(level.data, level.buddy_data, 1);
+    shift_data(extra_data, buddy_extra_data, 1);
+}
+
+void MemoryCheckpoint::recover_from_buddy()
+{
+    CH_TIME("MemoryCheckpoint::recover_from_buddy");
+    for (level_t &level : levels)
+        shift_data(level.buddy_data, level.data, -1);
+    shift_data(buddy_extra_data, extra_data, -1);
+}
+
+long long MemoryCheckpoint::num_bytes() const
+{
+    long long bytes =
+        (extra_data.size() + buddy_extra_data.size()) * sizeof(double);
+    for (const level_t &level : levels)
+    {
+        bytes += (level.data.size() + level.buddy_data.size()) * sizeof(Real);
+        bytes += level.boxes.size() * sizeof(Box);
+    }
+    return bytes;
+}
+
+template <class T>
+void MemoryCheckpoint::shift_data(const std::vector<T> &a_send,
+                                  std::vector<T> &a_recv, int a_offset)
+{
+#ifdef CH_MPI
+    const int num_ranks = numProc();
+    const int dest = (procID() + a_offset + num_ranks) % num_ranks;
+    const int source = (procID() - a_offset + num_ranks) % num_ranks;
+
+    long long send_size = a_send.size();
+    long long recv_size = 0;
+    MPI_Sendrecv(&send_size, 1, MPI_LONG_LONG, dest, 0, &recv_size, 1,
+                 MPI_LONG_LONG, source, 0, Chombo_MPI::comm,
+                 MPI_STATUS_IGNORE);
+    a_recv.resize(recv_size);
+
+    // MPI counts are ints so send (as bytes) in chunks which fit in one. All
+    // ranks do the same number of (possibly empty) exchanges so that they
+    // pair up
+    const long long chunk_bytes = 1LL << 30;
+    const long long send_bytes = send_size * sizeof(T);
+    const long long recv_bytes = recv_size * sizeof(T);
+    long long num_chunks =
+        (std::max(send_bytes, recv_bytes) + chunk_bytes - 1) / chunk_bytes;
+    MPI_Allreduce(MPI_IN_PLACE, &num_chunks, 1, MPI_LONG_LONG, MPI_MAX,
+                  Chombo_MPI::comm);
+
+    const char *send_ptr = reinterpret_cast<const char *>(a_send.data());
+    char *recv_ptr = reinterpret_cast<char *>(a_recv.data());
+    for (long long ichunk = 0; ichunk < num_chunks; ++ichunk)
+    {
+        const long long offset = ichunk * chunk_bytes;
+        const int send_count = static_cast<int>(
+            std::max(0LL, std::min(chunk_bytes, send_bytes - offset)));
+        const int recv_count = static_cast<int>(
+            std::max(0LL, std::min(chunk_bytes, recv_bytes - offset)));
+        MPI_Sendrecv(send_ptr + (send_count > 0 ? offset : 0), send_count,
+                     MPI_BYTE, dest, 1,
+                     recv_ptr + (recv_count > 0 ? offset : 0), recv_count,
+                     MPI_BYTE, source, 1, Chombo_MPI::comm,
+                     MPI_STATUS_IGNORE);
+    }
+#else
+    // with a single rank the buddy is this rank
+    a_recv = a_send;
+#endif
+}
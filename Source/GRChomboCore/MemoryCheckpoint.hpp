@@ -0,0 +1,77 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef MEMORYCHECKPOINT_HPP_
+#define MEMORYCHECKPOINT_HPP_
+
+// Chombo includes
+#include "Box.H"
+#include "REAL.H"
+#include "Vector.H"
+
+// Other includes
+#include <map>
+#include <string>
+#include <vector>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+/// A copy of the AMR hierarchy held in memory rather than written to disk
+/**
+ * GRAMR::write_memory_checkpoint fills this and GRAMR::read_memory_checkpoint
+ * rebuilds the hierarchy from it. Each rank holds the data of its own boxes
+ * and, after exchange_with_buddy, a copy of the data of the previous rank so
+ * that the data of any single rank can be recovered from its partner.
+ */
+class MemoryCheckpoint
+{
+  public:
+    //! The metadata and (this rank's) data of a level
+    struct level_t
+    {
+        double time = 0.;
+        double dt = 0.;
+        double dt_multiplier = 0.;     //!< the dt_multiplier dt was set with
+        Vector<Box> boxes;             //!< the grids before load balancing
+        std::vector<Real> data;        //!< the valid cells of the local boxes
+        std::vector<Real> buddy_data;  //!< data of the previous rank
+    };
+
+    int step = 0;          //!< the coarse step
+    double time = 0.;      //!< the coarse time
+    double dt_base = 0.;   //!< the coarse dt
+    int finest_level = -1; //!< the finest level (-1 if nothing is stored)
+    std::vector<level_t> levels;
+    std::vector<double> extra_data; //!< problem specific data (e.g. the
+                                    //!< puncture positions), which may
+                                    //!< differ between ranks
+    std::vector<double> buddy_extra_data; //!< extra_data of the previous rank
+    //! the size of each small data file (and its pending output) on rank 0
+    std::map<std::string, long long> small_data_sizes;
+
+    bool is_valid() const { return finest_level >= 0; }
+
+    //! Copies the data (and extra_data) of each rank into the buddy_data
+    //! (and buddy_extra_data) of the next one (collective)
+    void exchange_with_buddy();
+
+    //! Copies each rank's data back from the buddy_data of the next rank as
+    //! if it had been lost (collective)
+    void recover_from_buddy();
+
+    //! The memory used on this rank in bytes
+    long long num_bytes() const;
+
+  private:
+    //! Sends each rank's a_send to the rank a_offset after it and receives
+    //! into a_recv from the rank a_offset before it (in chunks so that any
+    //! size can be sent)
+    template <class T>
+    static void shift_data(const std::vector<T> &a_send,
+                           std::vector<T> &a_recv, int a_offset);
+};
+
+#endif /* MEMORYCHECKPOINT_HPP_ */
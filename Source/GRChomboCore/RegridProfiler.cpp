@@ -0,0 +1,236 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+// Chombo includes
+#include "BoxIterator.H"
+#include "IntVectSet.H"
+#include "SPMD.H"
+
+// Our includes
+#include "RegridProfiler.hpp"
+#include "SmallDataIO.hpp"
+
+// Other includes
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+const std::array<std::string, RegridProfiler::NUM_PHASES>
+    RegridProfiler::s_phase_names = {"tag",         "cluster",
+                                     "load_balance", "operators",
+                                     "move_data",    "interpolate",
+                                     "define_data"};
+
+RegridProfiler::RegridProfiler()
+    : m_active(false), m_regridding(false), m_first_write(true),
+      m_tagging_done(false)
+{
+    m_times.fill(0.);
+}
+
+void RegridProfiler::start_regrid()
+{
+    if (m_active)
+        m_regridding = true;
+}
+
+void RegridProfiler::add_time(Phase a_phase, double a_seconds)
+{
+    if (m_active && m_regridding)
+        m_times[a_phase] += a_seconds;
+}
+
+void RegridProfiler::tagging_finished()
+{
+    if (m_active && m_regridding)
+    {
+        m_tagging_end = Clock::now();
+        m_tagging_done = true;
+    }
+}
+
+void RegridProfiler::clustering_finished()
+{
+    if (m_tagging_done)
+    {
+        add_time(CLUSTERING, seconds_since(m_tagging_end));
+        m_tagging_done = false;
+    }
+}
+
+void RegridProfiler::add_churn(int a_level,
+                               const DisjointBoxLayout &a_old_grids,
+                               const DisjointBoxLayout &a_new_grids,
+                               int a_num_comps)
+{
+    if (m_active && m_regridding)
+        m_churn[a_level] = compute_churn(a_old_grids, a_new_grids, a_num_comps);
+}
+
+void RegridProfiler::write(const std::string &a_data_path, double a_time,
+                           double a_dt, double a_restart_time)
+{
+    if (!m_active || !m_regridding)
+        return;
+
+    // the slowest rank determines how long each phase took
+    std::vector<double> times(m_times.begin(), m_times.end());
+#ifdef CH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, times.data(), times.size(), MPI_DOUBLE,
+                  MPI_MAX, Chombo_MPI::comm);
+#endif
+    double total = 0.;
+    for (double time : times)
+        total += time;
+    times.push_back(total);
+
+    const bool first_step = m_first_write && (a_restart_time == 0.);
+
+    SmallDataIO timings_file(a_data_path + "regrid_timings", a_dt, a_time,
+                             a_restart_time, SmallDataIO::APPEND, first_step);
+    if (m_first_write)
+        timings_file.remove_duplicate_time_data();
+    if (first_step)
+    {
+        std::vector<std::string> header_strings(s_phase_names.begin(),
+                                                s_phase_names.end());
+        header_strings.push_back("total");
+        timings_file.write_header_line(header_strings);
+    }
+    timings_file.write_time_data_line(times);
+
+    // the churn is worked out from the global layouts so is the same on all
+    // ranks
+    SmallDataIO churn_file(a_data_path + "regrid_churn", a_dt, a_time,
+                           a_restart_time, SmallDataIO::APPEND, first_step);
+    if (m_first_write)
+        churn_file.remove_duplicate_time_data();
+    if (first_step)
+    {
+        const std::vector<std::string> pre_header_strings = {"time", "level"};
+        churn_file.write_header_line(
+            {"boxes_kept", "boxes_added", "boxes_removed", "cells_moved",
+             "bytes_moved", "cells_prolonged"},
+            pre_header_strings);
+    }
+    for (const auto &level_churn : m_churn)
+    {
+        const churn_t &churn = level_churn.second;
+        churn_file.write_data_line(
+            {static_cast<double>(churn.boxes_kept),
+             static_cast<double>(churn.boxes_added),
+             static_cast<double>(churn.boxes_removed),
+             static_cast<double>(churn.cells_moved),
+             static_cast<double>(churn.bytes_moved),
+             static_cast<double>(churn.cells_prolonged)},
+            {a_time, static_cast<double>(level_churn.first)});
+    }
+
+    m_first_write = false;
+    reset();
+}
+
+void RegridProfiler::reset()
+{
+    m_regridding = false;
+    m_tagging_done = false;
+    m_times.fill(0.);
+    m_churn.clear();
+}
+
+RegridProfiler::churn_t
+RegridProfiler::compute_churn(const DisjointBoxLayout &a_old_grids,
+                              const DisjointBoxLayout &a_new_grids,
+                              int a_num_comps)
+{
+    churn_t churn;
+
+    // a level that did not exist before has no old grids
+    std::vector<Box> old_boxes;
+    std::vector<int> old_procs;
+    if (a_old_grids.isClosed())
+    {
+        LayoutIterator lit = a_old_grids.layoutIterator();
+        for (lit.begin(); lit.ok(); ++lit)
+        {
+            old_boxes.push_back(a_old_grids[lit]);
+            old_procs.push_back(a_old_grids.procID(lit()));
+        }
+    }
+    std::vector<bool> old_box_kept(old_boxes.size(), false);
+
+    // bin the old boxes (with bins at least as large as any of them so each
+    // is in at most 2^CH_SPACEDIM bins) so that each new box is only compared
+    // with the old boxes near it
+    int bin_size = 1;
+    for (const Box &old_box : old_boxes)
+    {
+        for (int idir = 0; idir < CH_SPACEDIM; ++idir)
+            bin_size = std::max(bin_size, old_box.size(idir));
+    }
+
+    if (a_new_grids.isClosed())
+    {
+        const Box bins_box =
+            coarsen(a_new_grids.physDomain().domainBox(), bin_size);
+        std::unordered_map<long, std::vector<int>> old_boxes_in_bin;
+        for (int ibox = 0; ibox < old_boxes.size(); ++ibox)
+        {
+            const Box bins = coarsen(old_boxes[ibox], bin_size) & bins_box;
+            for (BoxIterator bit(bins); bit.ok(); ++bit)
+                old_boxes_in_bin[bins_box.index(bit())].push_back(ibox);
+        }
+
+        // an old box can be in several of the bins of a new box
+        std::vector<int> last_compared(old_boxes.size(), -1);
+        int num_compared = 0;
+        LayoutIterator lit = a_new_grids.layoutIterator();
+        for (lit.begin(); lit.ok(); ++lit, ++num_compared)
+        {
+            const Box &new_box = a_new_grids[lit];
+            const int new_proc = a_new_grids.procID(lit());
+            bool kept = false;
+            IntVectSet uncovered(new_box);
+            const Box bins = coarsen(new_box, bin_size) & bins_box;
+            for (BoxIterator bit(bins); bit.ok(); ++bit)
+            {
+                auto bin_it = old_boxes_in_bin.find(bins_box.index(bit()));
+                if (bin_it == old_boxes_in_bin.end())
+                    continue;
+                for (int ibox : bin_it->second)
+                {
+                    if (last_compared[ibox] == num_compared)
+                        continue;
+                    last_compared[ibox] = num_compared;
+                    const Box overlap = new_box & old_boxes[ibox];
+                    if (overlap.isEmpty())
+                        continue;
+                    if (old_boxes[ibox] == new_box)
+                    {
+                        kept = true;
+                        old_box_kept[ibox] = true;
+                    }
+                    if (old_procs[ibox] != new_proc)
+                        churn.cells_moved += overlap.numPts();
+                    uncovered -= overlap;
+                }
+            }
+            if (kept)
+                ++churn.boxes_kept;
+            else
+                ++churn.boxes_added;
+            churn.cells_prolonged += uncovered.numPts();
+        }
+    }
+
+    churn.boxes_removed =
+        std::count(old_box_kept.begin(), old_box_kept.end(), false);
+    churn.bytes_moved = churn.cells_moved * a_num_comps * sizeof(Real);
+
+    return churn;
+}
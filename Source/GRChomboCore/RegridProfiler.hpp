@@ -0,0 +1,130 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef REGRIDPROFILER_HPP_
+#define REGRIDPROFILER_HPP_
+
+// Chombo includes
+#include "DisjointBoxLayout.H"
+
+// Other includes
+#include <array>
+#include <chrono>
+#include <map>
+#include <string>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+/// Accumulates the time spent in each phase of a regrid and how much the
+/// grids changed on each level
+/**
+ * The GRAMRLevels add to this during a regrid and the base level writes it
+ * out in postRegrid. Times are the maximum over the ranks and go to
+ * "regrid_timings.dat" (one line per regrid). The grid churn goes to
+ * "regrid_churn.dat" (one line per regridded level). Nothing is recorded
+ * unless it is active (set by the write_regrid_stats parameter).
+ */
+class RegridProfiler
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    //! The phases of a regrid that are timed
+    enum Phase
+    {
+        TAG_CELLS,        //!< computing the tagging criterion
+        CLUSTERING,       //!< making boxes from the tags (in Chombo's AMR)
+        LOAD_BALANCE,     //!< assigning the new boxes to ranks
+        DEFINE_OPERATORS, //!< exchange copiers, averaging and interpolation
+        MOVE_DATA,        //!< moving the old data onto the new grids
+        INTERPOLATE,      //!< prolonging data onto newly refined regions
+        DEFINE_DATA,      //!< allocating the remaining LevelDatas
+        NUM_PHASES
+    };
+
+    //! How much the grids of a level changed at a regrid
+    struct churn_t
+    {
+        long long boxes_kept = 0;      //!< boxes in both the old and new grids
+        long long boxes_added = 0;     //!< boxes only in the new grids
+        long long boxes_removed = 0;   //!< boxes only in the old grids
+        long long cells_moved = 0;     //!< cells that changed rank
+        long long bytes_moved = 0;     //!< bytes of state data that moved
+        long long cells_prolonged = 0; //!< cells not covered by the old grids
+    };
+
+    //! Adds the time between construction and destruction to a phase
+    class ScopedTimer
+    {
+      public:
+        ScopedTimer(RegridProfiler &a_profiler, Phase a_phase)
+            : m_profiler(a_profiler), m_phase(a_phase), m_start(Clock::now())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            m_profiler.add_time(m_phase, seconds_since(m_start));
+        }
+
+      private:
+        RegridProfiler &m_profiler;
+        const Phase m_phase;
+        const std::chrono::time_point<Clock> m_start;
+    };
+
+    RegridProfiler();
+
+    void set_active(bool a_active) { m_active = a_active; }
+    bool is_active() const { return m_active; }
+
+    //! Called at the start of tagging which begins a regrid
+    void start_regrid();
+
+    //! Adds time to a phase (if active and regridding)
+    void add_time(Phase a_phase, double a_seconds);
+
+    //! Marks the end of tagging on a level; clustering follows the last one
+    void tagging_finished();
+
+    //! Marks the end of clustering (called once the new grids are known)
+    void clustering_finished();
+
+    //! Works out the grid churn of a level from its old and new grids
+    void add_churn(int a_level, const DisjointBoxLayout &a_old_grids,
+                   const DisjointBoxLayout &a_new_grids, int a_num_comps);
+
+    //! Writes the statistics of this regrid (call on all ranks) and resets
+    void write(const std::string &a_data_path, double a_time, double a_dt,
+               double a_restart_time);
+
+    //! Discards anything recorded (e.g. during the initial grid setup)
+    void reset();
+
+    //! Computes the churn between two grids (independent of the rank)
+    static churn_t compute_churn(const DisjointBoxLayout &a_old_grids,
+                                 const DisjointBoxLayout &a_new_grids,
+                                 int a_num_comps);
+
+    //! The names of the phases as written in the header
+    static const std::array<std::string, NUM_PHASES> s_phase_names;
+
+  private:
+    bool m_active;       //!< whether anything is recorded
+    bool m_regridding;   //!< whether a regrid is in progress
+    bool m_first_write;  //!< whether to overwrite any old files
+    bool m_tagging_done; //!< whether m_tagging_end marks the last tagging
+    std::chrono::time_point<Clock> m_tagging_end;
+    std::array<double, NUM_PHASES> m_times;
+    std::map<int, churn_t> m_churn; //!< the churn on each regridded level
+
+    static double seconds_since(const std::chrono::time_point<Clock> &a_start)
+    {
+        return std::chrono::duration<double>(Clock::now() - a_start).count();
+    }
+};
+
+#endif /* REGRIDPROFILER_HPP_ */
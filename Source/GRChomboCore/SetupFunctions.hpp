@@ -14,6 +14,9 @@
 
 // Other includes
 #include <iostream>
+#include <set>
+#include <string>
+#include <unistd.h>
 using std::cerr;
 using std::endl;
 #include "ChomboParameters.hpp"
@@ -22,6 +25,7 @@ using std::endl;
 #include "GRAMR.hpp"
 #include "GRParmParse.hpp"
 #include "IntegrationMethodSetup.hpp"
+#include "SmallDataIOBuffer.hpp"
 
 #include "simd.hpp"
 
@@ -37,7 +41,21 @@ using std::endl;
 #include "UsingNamespace.H"
 
 /// This function calls MPI_Init, makes sure a parameter file is supplied etc...
-void mainSetup(int argc, char *argv[]);
+void mainSetup(int &argc, char **&argv);
+
+/// If the first argument is --ensemble, splits the ranks between the
+/// parameter files which follow it so that each runs independently
+/**
+ * With "<executable> --ensemble run_1/params.txt ... run_n/params.txt" the
+ * ranks are split into n contiguous blocks of (nearly) equal size and each
+ * block runs one of the parameter files as if it had been run on its own.
+ * Chombo (and GRChombo) do all their communication through Chombo_MPI::comm
+ * so this is replaced by the communicator of the block. Each block changes
+ * into the directory of its parameter file so that any relative output paths
+ * (including the pout and timer files) are separate, which is why each file
+ * must be in a different directory.
+ */
+void setupEnsemble(int &argc, char **&argv);
 
 /// This function calls all finalisations
 void mainFinalize();
@@ -45,7 +63,7 @@ void mainFinalize();
 /// Sets up the grid parameters, problem domain and AMR object
 void setupAMRObject(AMR &gr_amr, AMRLevelFactory &a_factory);
 
-void mainSetup(int argc, char *argv[])
+void mainSetup(int &argc, char **&argv)
 {
 #ifdef CH_MPI
     // Start MPI
@@ -54,6 +72,9 @@ void mainSetup(int argc, char *argv[])
     H5dont_atexit();
 #endif
 // setChomboMPIErrorHandler();
+
+    // Must be before anything else uses Chombo_MPI::comm
+    setupEnsemble(argc, argv);
 #endif
 
     int rank, number_procs;
@@ -90,13 +111,86 @@ void mainSetup(int argc, char *argv[])
     }
 }
 
+void setupEnsemble(int &argc, char **&argv)
+{
+#ifdef CH_MPI
+    if (argc < 3 || std::string(argv[1]) != "--ensemble")
+        return;
+
+    int world_rank, world_size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    const int num_members = argc - 2;
+
+    std::set<std::string> directories;
+    for (int imember = 0; imember < num_members; ++imember)
+    {
+        const std::string params_file = argv[imember + 2];
+        const size_t slash_pos = params_file.rfind('/');
+        directories.insert(slash_pos == std::string::npos
+                               ? std::string(".")
+                               : params_file.substr(0, slash_pos));
+    }
+    if (num_members > world_size ||
+        static_cast<int>(directories.size()) != num_members)
+    {
+        if (world_rank == 0)
+        {
+            cerr << " usage " << argv[0]
+                 << " --ensemble <dir_1/input_file_name> ... "
+                    "<dir_n/input_file_name> (with n <= number of ranks and "
+                    "each input file in a different directory)"
+                 << endl;
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    const int member =
+        static_cast<long long>(world_rank) * num_members / world_size;
+    MPI_Comm member_comm;
+    MPI_Comm_split(MPI_COMM_WORLD, member, world_rank, &member_comm);
+    Chombo_MPI::comm = member_comm;
+
+    // run as if the parameter file had been given on its own in its directory
+    const std::string params_file = argv[member + 2];
+    const size_t slash_pos = params_file.rfind('/');
+    if (slash_pos != std::string::npos)
+    {
+        const std::string directory = params_file.substr(0, slash_pos);
+        if (chdir(directory.c_str()) != 0)
+        {
+            cerr << " cannot change to directory " << directory << endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        argv[member + 2] += slash_pos + 1;
+    }
+    argv[1] = argv[member + 2];
+    argc = 2;
+
+    int member_rank, member_size;
+    MPI_Comm_rank(member_comm, &member_rank);
+    MPI_Comm_size(member_comm, &member_size);
+    if (member_rank == 0)
+    {
+        std::cout << " ensemble member " << member << " of " << num_members
+                  << " (" << params_file << ") on " << member_size
+                  << " ranks" << endl;
+    }
+#endif
+}
+
 void mainFinalize()
 {
+    // write any small data output still buffered
+    SmallDataIOBuffer::flush();
+
 #ifdef CH_MPI
     // Exit MPI
 #ifdef CH_USE_MEMORY_TRACKING
     dumpmemoryatexit();
 #endif
+    if (Chombo_MPI::comm != MPI_COMM_WORLD)
+        MPI_Comm_free(&Chombo_MPI::comm);
     MPI_Finalize();
 #endif
 }
@@ -152,6 +246,39 @@ void setupAMRObject(GRAMR &gr_amr, AMRLevelFactory &a_factory)
     // Set verbosity
     gr_amr.verbosity(chombo_params.verbosity);
 
+    // Whether diagnostics output is done in the background
+    gr_amr.m_diagnostics_queue.set_asynchronous(
+        chombo_params.async_diagnostics);
+
+    // Whether small data output is buffered
+    SmallDataIOBuffer::set_flush_interval(
+        chombo_params.small_data_flush_interval);
+
+    // Whether to profile regrids
+    gr_amr.m_regrid_profiler.set_active(chombo_params.write_regrid_stats);
+
+    // Whether to checkpoint and stop before the job's walltime limit or when
+    // the job is signalled
+    gr_amr.m_walltime_monitor.set_limit(chombo_params.walltime_limit,
+                                        chombo_params.walltime_safety_margin);
+    gr_amr.m_walltime_monitor.set_checkpoint_rate_estimate(
+        chombo_params.walltime_checkpoint_rate * 1.e6);
+    if (chombo_params.checkpoint_on_signal)
+        gr_amr.m_walltime_monitor.install_signal_handlers();
+
+    // Keep frequent cheap checkpoints in memory
+    gr_amr.set_memory_checkpoint_interval(
+        chombo_params.memory_checkpoint_interval);
+
+    // Roll back and retry on nans
+    gr_amr.set_nan_rollback(chombo_params.nan_rollback_retries,
+                            chombo_params.nan_rollback_snapshots,
+                            chombo_params.nan_rollback_dt_factor,
+                            chombo_params.nan_rollback_sigma_factor,
+                            chombo_params.nan_rollback_regrid);
+    // the small data output of a step is held back until it has no nans
+    SmallDataIOBuffer::set_hold_output(chombo_params.nan_rollback_retries > 0);
+
     // Set timeEps to half of finest level dt
     // Chombo sets it to 1.e-6 by default (AMR::setDefaultValues in AMR.cpp)
     // This is only not enough for >~20 levels
@@ -168,7 +295,18 @@ void setupAMRObject(GRAMR &gr_amr, AMRLevelFactory &a_factory)
             FilesystemTools::mkdir_recursive(chombo_params.hdf5_path);
 #endif
 
+        // only the grids are needed in a dry run
+        gr_amr.set_dry_run(chombo_params.dry_run);
+#ifdef CH_USE_HDF5
+        if (chombo_params.warm_start && !chombo_params.dry_run)
+        {
+            gr_amr.m_warm_start.read_checkpoint(
+                chombo_params.hdf5_path + chombo_params.warm_start_file,
+                physdomain, chombo_params.coarsest_dx);
+        }
+#endif
         gr_amr.setupForNewAMRRun();
+        gr_amr.m_warm_start.clear();
     }
     else
     {
@@ -182,6 +320,18 @@ void setupAMRObject(GRAMR &gr_amr, AMRLevelFactory &a_factory)
         MayDay::Error("GRChombo restart only defined with hdf5");
 #endif
     }
+
+    // Time the candidate box sizes on the initial hierarchy. Chombo only has
+    // a single max box size so the best overall is applied (to the current
+    // levels and all future regrids)
+    if (chombo_params.autotune_box_size)
+    {
+        const int best_box_size = gr_amr.autotune_box_size(
+            chombo_params.autotune_box_sizes,
+            chombo_params.autotune_num_trials);
+        if (chombo_params.autotune_apply)
+            gr_amr.apply_max_box_size(best_box_size);
+    }
 }
 
 #endif /* SETUP_FUNCTIONS_HPP_ */
@@ -54,7 +54,8 @@ class SimulationParametersBase : public ChomboParameters
         pp.load("sigma", sigma, 0.1);
 
         // Nan Check and min chi and lapse values
-        pp.load("nan_check", nan_check, true);
+        // NanCheck aborts the run so cannot be used with nan rollback
+        pp.load("nan_check", nan_check, nan_rollback_retries == 0);
         pp.load("min_chi", min_chi, 1e-4);
         pp.load("min_lapse", min_lapse, 1e-4);
 
@@ -140,6 +141,11 @@ class SimulationParametersBase : public ChomboParameters
             pp.load("write_extraction", extraction_params.write_extraction,
                     false);
 
+            // interpolate the extracted data in time to output it more often
+            // than the extraction level steps (0 to disable)
+            pp.load("extraction_dense_output_dt",
+                    extraction_params.dense_output_dt, 0.);
+
             std::string extraction_path;
             pp.load("extraction_subpath", extraction_path, data_path);
             if (!extraction_path.empty() && extraction_path.back() != '/')
@@ -171,8 +177,12 @@ class SimulationParametersBase : public ChomboParameters
                         (sigma >= 0.0) && (sigma <= 2.0 / dt_multiplier),
                         "must be >= 0.0 and <= 2 / dt_multiplier for stability "
                         "(see Alcubierre p344)");
-        warn_parameter("nan_check", nan_check, nan_check,
+        warn_parameter("nan_check", nan_check,
+                       nan_check || nan_rollback_retries > 0,
                        "should not normally be disabled");
+        check_parameter("nan_check", nan_check,
+                        !nan_check || nan_rollback_retries == 0,
+                        "must be false if nan_rollback_retries > 0");
         // not sure these are necessary hence commented out
         // check_parameter("min_chi", min_chi, (min_chi >= 0.0), "must be >=
         // 0.0"); check_parameter("min_lapse", min_lapse, (min_lapse >= 0.0)
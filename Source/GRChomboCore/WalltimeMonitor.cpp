@@ -0,0 +1,102 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+// Chombo includes
+#include "SPMD.H"
+
+// Our includes
+#include "WalltimeMonitor.hpp"
+
+// Other includes
+#include <algorithm>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+volatile std::sig_atomic_t WalltimeMonitor::s_signal_received = 0;
+
+WalltimeMonitor::WalltimeMonitor()
+    : m_limit(0.), m_margin(0.), m_handle_signals(false),
+      m_last_step_end(0.), m_checkpoint_duration(0.),
+      m_checkpoint_seconds_per_byte(0.), m_checkpoint_seconds(0.)
+{
+}
+
+void WalltimeMonitor::set_limit(double a_limit, double a_margin)
+{
+    m_limit = a_limit;
+    m_margin = a_margin;
+}
+
+void WalltimeMonitor::set_checkpoint_rate_estimate(double a_bytes_per_second)
+{
+    m_checkpoint_seconds_per_byte = 1. / a_bytes_per_second;
+}
+
+void WalltimeMonitor::install_signal_handlers()
+{
+    m_handle_signals = true;
+    std::signal(SIGUSR1, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+}
+
+void WalltimeMonitor::start(double a_walltime)
+{
+    m_last_step_end = a_walltime;
+    m_checkpoint_seconds = 0.;
+}
+
+void WalltimeMonitor::step_finished(double a_walltime,
+                                    double a_checkpoint_bytes)
+{
+    // a checkpoint written during the step will not be written every step so
+    // is accounted for separately (and its rate replaces the estimate)
+    const double checkpoint_duration = m_checkpoint_seconds / 3600.;
+    if (m_checkpoint_seconds > 0. && a_checkpoint_bytes > 0.)
+    {
+        m_checkpoint_seconds_per_byte =
+            m_checkpoint_seconds / a_checkpoint_bytes;
+    }
+    m_checkpoint_seconds = 0.;
+    m_checkpoint_duration =
+        a_checkpoint_bytes * m_checkpoint_seconds_per_byte / 3600.;
+
+    m_step_durations.push_back(a_walltime - m_last_step_end -
+                               checkpoint_duration);
+    if (m_step_durations.size() > s_num_steps_kept)
+        m_step_durations.pop_front();
+    m_last_step_end = a_walltime;
+}
+
+void WalltimeMonitor::add_checkpoint_time(double a_seconds)
+{
+    m_checkpoint_seconds += a_seconds;
+}
+
+bool WalltimeMonitor::should_stop(double a_walltime) const
+{
+    int stop = signal_received();
+    if (m_limit > 0.)
+    {
+        double next_step_duration = 0.;
+        if (!m_step_durations.empty())
+        {
+            next_step_duration = *std::max_element(m_step_durations.begin(),
+                                                   m_step_durations.end());
+        }
+        const double finish_time =
+            a_walltime + next_step_duration + m_checkpoint_duration + m_margin;
+        if (finish_time > m_limit)
+            stop = 1;
+    }
+
+    // the signal may only reach some ranks and the times differ slightly
+#ifdef CH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &stop, 1, MPI_INT, MPI_MAX, Chombo_MPI::comm);
+#endif
+    return stop != 0;
+}
+
+void WalltimeMonitor::signal_handler(int a_signal) { s_signal_received = 1; }
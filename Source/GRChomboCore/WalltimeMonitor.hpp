@@ -0,0 +1,77 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef WALLTIMEMONITOR_HPP_
+#define WALLTIMEMONITOR_HPP_
+
+// Other includes
+#include <csignal>
+#include <deque>
+
+/// Decides when to checkpoint and stop a run before the job's walltime limit
+/// is reached (or when the job is sent a signal)
+/**
+ * GRAMR::run calls step_finished after each coarse step and asks
+ * should_stop whether there is still time for another step followed by a
+ * checkpoint. The time of a step is estimated from the slowest of the last
+ * few and the time of a checkpoint from the current size of the data at the
+ * rate the last one was written (the GRAMRLevels add the time they spend
+ * writing) or, until one has been written, at an assumed rate. All times are
+ * walltimes in hours since GRAMR was constructed (as from
+ * GRAMR::get_walltime).
+ */
+class WalltimeMonitor
+{
+  public:
+    WalltimeMonitor();
+
+    //! Stop when fewer than a_margin hours would be left of a_limit hours
+    //! after another step and a checkpoint (a_limit <= 0 disables this)
+    void set_limit(double a_limit, double a_margin);
+
+    //! The rate (in bytes per second) to assume checkpoints are written at
+    //! until one has been timed
+    void set_checkpoint_rate_estimate(double a_bytes_per_second);
+
+    //! Also stop after the current coarse step on SIGUSR1 or SIGTERM
+    void install_signal_handlers();
+
+    //! Whether there is any reason to stop early
+    bool is_active() const { return m_limit > 0. || m_handle_signals; }
+
+    //! Called at the start of the run
+    void start(double a_walltime);
+
+    //! Called at the end of each coarse step with the size of the data a
+    //! checkpoint would write now
+    void step_finished(double a_walltime, double a_checkpoint_bytes);
+
+    //! Adds time (in seconds) spent writing the current checkpoint
+    void add_checkpoint_time(double a_seconds);
+
+    //! Whether to checkpoint and stop now (the same on all ranks)
+    bool should_stop(double a_walltime) const;
+
+    //! Whether one of the signals has been received (on this rank)
+    static bool signal_received() { return s_signal_received != 0; }
+
+  private:
+    static const int s_num_steps_kept = 5;
+
+    double m_limit;  //!< the job's walltime limit
+    double m_margin; //!< the time to leave spare
+    bool m_handle_signals;
+    double m_last_step_end;
+    std::deque<double> m_step_durations; //!< of the last few coarse steps
+    double m_checkpoint_duration;        //!< estimated for the next one
+    double m_checkpoint_seconds_per_byte; //!< of the last checkpoint (or the
+                                          //!< assumed rate)
+    double m_checkpoint_seconds; //!< spent writing since the last step ended
+
+    static volatile std::sig_atomic_t s_signal_received;
+    static void signal_handler(int a_signal);
+};
+
+#endif /* WALLTIMEMONITOR_HPP_ */
@@ -0,0 +1,198 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+// Chombo includes
+#include "CH_HDF5.H"
+#include "CH_Timer.H"
+#include "CoarseAverage.H"
+#include "FourthOrderFineInterp.H"
+#include "IntVectSet.H"
+#include "LoadBalance.H"
+
+// Our includes
+#include "WarmStart.hpp"
+
+// Other includes
+#include <cmath>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+#ifdef CH_USE_HDF5
+void WarmStart::read_checkpoint(const std::string &a_filename,
+                                const ProblemDomain &a_domain,
+                                double a_coarsest_dx)
+{
+    CH_TIME("WarmStart::read_checkpoint");
+
+    HDF5Handle handle(a_filename, HDF5Handle::OPEN_RDONLY);
+    HDF5HeaderData header;
+    header.readFromFile(handle);
+    if (header.m_int.find("num_levels") == header.m_int.end() ||
+        header.m_int.find("num_components") == header.m_int.end())
+    {
+        MayDay::Error("WarmStart::read_checkpoint: file does not contain "
+                      "num_levels or num_components");
+    }
+    const int num_levels = header.m_int["num_levels"];
+    const int num_comps = header.m_int["num_components"];
+    const Interval comps(0, num_comps - 1);
+
+    m_levels.resize(num_levels);
+    for (int ilevel = 0; ilevel < num_levels; ++ilevel)
+    {
+        handle.setGroup("level_" + std::to_string(ilevel));
+        HDF5HeaderData level_header;
+        level_header.readFromFile(handle);
+        if (level_header.m_real.find("dx") == level_header.m_real.end() ||
+            level_header.m_box.find("prob_domain") ==
+                level_header.m_box.end())
+        {
+            MayDay::Error("WarmStart::read_checkpoint: file does not "
+                          "contain dx or prob_domain");
+        }
+        // the time and puncture positions are not restored so only initial
+        // data can be taken
+        if (level_header.m_real.find("time") != level_header.m_real.end() &&
+            level_header.m_real["time"] != 0.)
+        {
+            MayDay::Error("WarmStart::read_checkpoint: the checkpoint is not "
+                          "at t = 0 (only initial data can be warm started, "
+                          "use restart_file to continue an evolved run)");
+        }
+        level_t &level = m_levels[ilevel];
+        level.dx = level_header.m_real["dx"];
+        const Box domain_box = level_header.m_box["prob_domain"];
+
+        // the physical domain must be the same
+        if (ilevel == 0)
+        {
+            for (int dir = 0; dir < SpaceDim; ++dir)
+            {
+                const double L = domain_box.size(dir) * level.dx;
+                const double new_L =
+                    a_domain.domainBox().size(dir) * a_coarsest_dx;
+                if (std::abs(L - new_L) > 1e-8 * new_L)
+                {
+                    MayDay::Error("WarmStart::read_checkpoint: the checkpoint "
+                                  "does not have the same L as this run");
+                }
+            }
+        }
+
+        if (read(handle, level.boxes) != 0)
+        {
+            MayDay::Error("WarmStart::read_checkpoint: file does not "
+                          "contain a Vector<Box>");
+        }
+        Vector<int> procs;
+        LoadBalance(procs, level.boxes);
+        bool is_periodic[SpaceDim];
+        for (int dir = 0; dir < SpaceDim; ++dir)
+            is_periodic[dir] = a_domain.isPeriodic(dir);
+        const DisjointBoxLayout grids(level.boxes, procs,
+                                      ProblemDomain(domain_box, is_periodic));
+
+        level.data = RefCountedPtr<LevelData<FArrayBox>>(
+            new LevelData<FArrayBox>(grids, num_comps, IntVect::Zero));
+        if (read<FArrayBox>(handle, *level.data, "data", grids, comps,
+                            false) != 0)
+        {
+            MayDay::Error("WarmStart::read_checkpoint: file does not "
+                          "contain state data");
+        }
+    }
+    handle.close();
+
+    pout() << "WarmStart::read_checkpoint: read " << num_levels
+           << " levels from " << a_filename << endl;
+}
+#endif
+
+void WarmStart::fill(LevelData<FArrayBox> &a_state, double a_dx,
+                     const ProblemDomain &a_domain) const
+{
+    CH_TIME("WarmStart::fill");
+
+    for (const level_t &level : m_levels)
+    {
+        const LevelData<FArrayBox> &data = *level.data;
+        if (data.nComp() != a_state.nComp())
+        {
+            MayDay::Error("WarmStart::fill: the checkpoint does not have the "
+                          "same number of components as this run");
+        }
+
+        const double ratio = level.dx / a_dx;
+        if (std::abs(ratio - 1.) < 1e-8)
+            data.copyTo(data.interval(), a_state, a_state.interval());
+        else if (ratio > 1.)
+        {
+            const int ref_ratio = std::round(ratio);
+            if (std::abs(ratio - ref_ratio) > 1e-8 * ratio)
+            {
+                MayDay::Error("WarmStart::fill: the checkpoint's dx is not an "
+                              "integer multiple of this run's dx");
+            }
+            prolong(level, a_state, ref_ratio, a_domain);
+        }
+        else
+        {
+            const int coarsen_ratio = std::round(1. / ratio);
+            if (std::abs(1. / ratio - coarsen_ratio) > 1e-8 / ratio ||
+                !data.disjointBoxLayout().coarsenable(coarsen_ratio))
+            {
+                MayDay::Error("WarmStart::fill: the checkpoint's grids can "
+                              "not be coarsened to this run's dx");
+            }
+            CoarseAverage averager(data.disjointBoxLayout(), data.nComp(),
+                                   coarsen_ratio);
+            averager.averageToCoarse(a_state, data);
+        }
+    }
+}
+
+void WarmStart::prolong(const level_t &a_level, LevelData<FArrayBox> &a_state,
+                        int a_ref_ratio, const ProblemDomain &a_domain) const
+{
+    const DisjointBoxLayout &grids = a_state.disjointBoxLayout();
+    if (!grids.coarsenable(a_ref_ratio))
+    {
+        MayDay::Error("WarmStart::prolong: the grids can not be coarsened to "
+                      "the checkpoint's dx");
+    }
+
+    FourthOrderFineInterp interp;
+    interp.define(grids, a_state.nComp(), a_ref_ratio, a_domain);
+    LevelData<FArrayBox> prolonged(grids, a_state.nComp());
+    interp.interpToFine(prolonged, *a_level.data);
+
+    // the interpolation is only right where the whole stencil is covered by
+    // the checkpoint level (or outside the domain)
+    const Box coarse_domain_box = coarsen(a_domain.domainBox(), a_ref_ratio);
+    DataIterator dit = grids.dataIterator();
+    for (dit.begin(); dit.ok(); ++dit)
+    {
+        const Box coarse_box = coarsen(grids[dit], a_ref_ratio);
+        const Box stencil_box =
+            grow(coarse_box, s_interp_stencil_width) & coarse_domain_box;
+        IntVectSet uncovered(stencil_box);
+        for (int ibox = 0; ibox < a_level.boxes.size(); ++ibox)
+        {
+            if (a_level.boxes[ibox].intersectsNotEmpty(stencil_box))
+                uncovered -= a_level.boxes[ibox];
+        }
+        uncovered.grow(s_interp_stencil_width);
+        IntVectSet valid(coarse_box);
+        valid -= uncovered;
+
+        const Vector<Box> valid_boxes = valid.boxes();
+        for (int ibox = 0; ibox < valid_boxes.size(); ++ibox)
+        {
+            a_state[dit].copy(prolonged[dit],
+                              refine(valid_boxes[ibox], a_ref_ratio));
+        }
+    }
+}
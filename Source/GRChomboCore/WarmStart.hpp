@@ -0,0 +1,76 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef WARMSTART_HPP_
+#define WARMSTART_HPP_
+
+// Chombo includes
+#include "FArrayBox.H"
+#include "LevelData.H"
+#include "ProblemDomain.H"
+#include "RefCountedPtr.H"
+
+// Other includes
+#include <string>
+#include <vector>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+/// Holds the data of a checkpoint at a different resolution from which the
+/// initial data of a new run is taken
+/**
+ * The checkpoint must cover the same physical domain but may have a
+ * different N_full, max_level or refinement ratios. Each level of the new
+ * hierarchy is filled from every level of the checkpoint, coarsest first, by
+ * copying (same dx), fourth order interpolation (coarser dx) or averaging
+ * (finer dx), wherever the checkpoint level covers it. Whatever is not
+ * covered by the checkpoint keeps the values interpolated from the coarser
+ * level of the new hierarchy. Only checkpoints at t = 0 are accepted as the
+ * new run starts at t = 0 (with e.g. the punctures at their initial
+ * positions).
+ */
+class WarmStart
+{
+  public:
+#ifdef CH_USE_HDF5
+    //! Reads every level of the checkpoint a_filename onto a balanced layout
+    //! (collective). a_domain and a_coarsest_dx are those of the new run.
+    void read_checkpoint(const std::string &a_filename,
+                         const ProblemDomain &a_domain,
+                         double a_coarsest_dx);
+#endif
+
+    bool is_active() const { return !m_levels.empty(); }
+
+    //! Fills the valid cells of a_state (a level with spacing a_dx in
+    //! a_domain) covered by the checkpoint (collective)
+    void fill(LevelData<FArrayBox> &a_state, double a_dx,
+              const ProblemDomain &a_domain) const;
+
+    //! Frees the checkpoint data
+    void clear() { m_levels.clear(); }
+
+  private:
+    struct level_t
+    {
+        double dx;
+        Vector<Box> boxes;
+        RefCountedPtr<LevelData<FArrayBox>> data;
+    };
+
+    //! The number of coarse cells (in each direction) needed around a cell
+    //! for FourthOrderFineInterp
+    static const int s_interp_stencil_width = 2;
+
+    std::vector<level_t> m_levels;
+
+    //! Interpolates a_level onto the cells of a_state at least
+    //! s_interp_stencil_width coarse cells inside the checkpoint level
+    void prolong(const level_t &a_level, LevelData<FArrayBox> &a_state,
+                 int a_ref_ratio, const ProblemDomain &a_domain) const;
+};
+
+#endif /* WARMSTART_HPP_ */
@@ -16,7 +16,9 @@
 //! This class tags cells based on three criteria - the
 //! value of the second derivs, the extraction regions
 //! and the puncture horizons (which must be covered to
-//! a given level
+//! a given level). If puncture displacements are given, the
+//! region swept by each horizon as the puncture moves by its
+//! displacement (a capsule) is tagged rather than a sphere
 class ChiPunctureExtractionTaggingCriterion
 {
   protected:
@@ -29,6 +31,8 @@ class ChiPunctureExtractionTaggingCriterion
     const SphericalExtraction::params_t m_params;
     const std::vector<double> m_puncture_masses;
     const std::vector<std::array<double, CH_SPACEDIM>> &m_puncture_coords;
+    const std::vector<std::array<double, CH_SPACEDIM>>
+        m_puncture_displacements;
 
   public:
     template <class data_t> struct Vars
@@ -51,17 +55,59 @@ class ChiPunctureExtractionTaggingCriterion
         const std::vector<std::array<double, CH_SPACEDIM>> &a_puncture_coords,
         const bool activate_extraction = false,
         const bool track_punctures = false,
-        const std::vector<double> a_puncture_masses = {1.0, 1.0})
+        const std::vector<double> a_puncture_masses = {1.0, 1.0},
+        const std::vector<std::array<double, CH_SPACEDIM>>
+            a_puncture_displacements = {})
         : m_dx(dx), m_level(a_level), m_max_level(a_max_level),
           m_track_punctures(track_punctures),
           m_activate_extraction(activate_extraction), m_deriv(dx),
           m_params(a_params), m_puncture_masses(a_puncture_masses),
-          m_puncture_coords(a_puncture_coords)
+          m_puncture_coords(a_puncture_coords),
+          m_puncture_displacements(a_puncture_displacements)
     {
         // check that the number of punctures is consistent
         CH_assert(m_puncture_masses.size() == m_puncture_coords.size());
+        CH_assert(m_puncture_displacements.empty() ||
+                  m_puncture_displacements.size() == m_puncture_coords.size());
     };
 
+    //! The radius tagged around a puncture of mass a_mass on a_level (if it
+    //! is one of the finest three levels): the horizon plus a fudge factor of
+    //! 1.5, doubling on each coarser level
+    static double tagged_puncture_radius(double a_mass, int a_level,
+                                         int a_max_level)
+    {
+        // we want each level to be double the innermost one in size
+        const double factor = pow(2.0, a_max_level - a_level - 1);
+        return 1.5 * factor * a_mass;
+    }
+
+    //! The distance from coords (centred on the start of the segment) to the
+    //! segment with the given displacement
+    template <class data_t>
+    static data_t
+    distance_to_segment(const Coordinates<data_t> &coords,
+                        const std::array<double, CH_SPACEDIM> &a_displacement)
+    {
+        const double length2 = a_displacement[0] * a_displacement[0] +
+                               a_displacement[1] * a_displacement[1] +
+                               a_displacement[2] * a_displacement[2];
+        if (length2 < 1e-12)
+            return coords.get_radius();
+
+        // the parameter of the closest point on the segment
+        data_t t = (coords.x * a_displacement[0] +
+                    coords.y * a_displacement[1] +
+                    coords.z * a_displacement[2]) /
+                   length2;
+        t = simd_min(simd_max(t, 0.), 1.);
+
+        const data_t dx = coords.x - t * a_displacement[0];
+        const data_t dy = coords.y - t * a_displacement[1];
+        const data_t dz = coords.z - t * a_displacement[2];
+        return sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
     template <class data_t> void compute(Cell<data_t> current_cell) const
     {
         // first test the gradients for regions of high curvature
@@ -104,8 +150,6 @@ class ChiPunctureExtractionTaggingCriterion
         // the top levels are well spaced)
         if ((m_level > (m_max_level - 3)) && (m_track_punctures == 1))
         {
-            // we want each level to be double the innermost one in size
-            const double factor = pow(2.0, m_max_level - m_level - 1);
             // loop over puncture masses
             for (int ipuncture = 0; ipuncture < m_puncture_masses.size();
                  ++ipuncture)
@@ -113,11 +157,15 @@ class ChiPunctureExtractionTaggingCriterion
                 // where am i?
                 const Coordinates<data_t> coords(current_cell, m_dx,
                                                  m_puncture_coords[ipuncture]);
-                const data_t r = coords.get_radius();
+                const data_t r =
+                    m_puncture_displacements.empty()
+                        ? coords.get_radius()
+                        : distance_to_segment(
+                              coords, m_puncture_displacements[ipuncture]);
                 // decide whether to tag based on distance to horizon
-                // plus a fudge factor of 1.5
                 auto regrid = simd_compare_lt(
-                    r, 1.5 * factor * m_puncture_masses[ipuncture]);
+                    r, tagged_puncture_radius(m_puncture_masses[ipuncture],
+                                              m_level, m_max_level));
                 criterion = simd_conditional(regrid, 100.0, criterion);
             }
         }
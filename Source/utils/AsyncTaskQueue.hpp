@@ -0,0 +1,129 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef ASYNCTASKQUEUE_HPP_
+#define ASYNCTASKQUEUE_HPP_
+
+// Other includes
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/// A FIFO of tasks that are run in order on a single background thread
+/**
+ * This is used to take work that needs no MPI communication (e.g. surface
+ * integrals and writing of small data files on rank 0) off the critical path
+ * of the evolution. Tasks are always run in the order they are pushed so any
+ * output is identical to running them synchronously. If the queue is not
+ * asynchronous (the default), push() simply runs the task immediately.
+ * Tasks must not call MPI (procID() is fine as Chombo caches it) and must
+ * only capture data they own, e.g. by value or through a shared_ptr.
+ * Grid computations can only be done in the background on a copy of the
+ * data (see DiagnosticsSnapshot) whilst interpolation and reductions need
+ * MPI so must stay on the main thread (see GRAMR::defer_diagnostics).
+ */
+class AsyncTaskQueue
+{
+  public:
+    using task_t = std::function<void()>;
+
+    AsyncTaskQueue(bool a_asynchronous = false)
+        : m_asynchronous(a_asynchronous), m_busy(false), m_stop(false)
+    {
+    }
+
+    //! Waits for the remaining tasks to finish
+    ~AsyncTaskQueue()
+    {
+        wait();
+        if (m_worker.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_task_added.notify_one();
+            m_worker.join();
+        }
+    }
+
+    //! Switch between running tasks in the background or immediately
+    void set_asynchronous(bool a_asynchronous)
+    {
+        if (!a_asynchronous)
+            wait();
+        m_asynchronous = a_asynchronous;
+    }
+
+    bool is_asynchronous() const { return m_asynchronous; }
+
+    //! Add a task to the end of the queue (or run it now if not asynchronous)
+    void push(task_t a_task)
+    {
+        if (!m_asynchronous)
+        {
+            a_task();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // only start the worker when it is first needed
+            if (!m_worker.joinable())
+                m_worker = std::thread(&AsyncTaskQueue::worker_loop, this);
+            m_tasks.push_back(std::move(a_task));
+        }
+        m_task_added.notify_one();
+    }
+
+    //! Block until all tasks pushed so far have finished (e.g. before
+    //! checkpointing or reading back any files the tasks write)
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_queue_empty.wait(lock,
+                           [this]() { return m_tasks.empty() && !m_busy; });
+    }
+
+  private:
+    bool m_asynchronous; //!< whether tasks are run in the background
+    bool m_busy;         //!< whether the worker is running a task
+    bool m_stop;         //!< tells the worker to finish
+    std::deque<task_t> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_task_added;
+    std::condition_variable m_queue_empty;
+    std::thread m_worker;
+
+    void worker_loop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_task_added.wait(lock,
+                              [this]() { return m_stop || !m_tasks.empty(); });
+            if (m_tasks.empty())
+                return; // m_stop must be true
+
+            task_t task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            m_busy = true;
+            lock.unlock();
+            task();
+            lock.lock();
+            m_busy = false;
+            if (m_tasks.empty())
+                m_queue_empty.notify_all();
+        }
+    }
+
+    // the worker thread holds a pointer to this
+    AsyncTaskQueue(const AsyncTaskQueue &) = delete;
+    AsyncTaskQueue &operator=(const AsyncTaskQueue &) = delete;
+};
+
+#endif /* ASYNCTASKQUEUE_HPP_ */
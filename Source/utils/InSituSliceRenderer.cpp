@@ -0,0 +1,273 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+// Chombo includes
+#include "CH_Timer.H"
+#include "SPMD.H"
+
+// Our includes
+#include "InSituSliceRenderer.hpp"
+
+// Other includes
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+InSituSliceRenderer::InSituSliceRenderer(int a_var, VariableType a_var_type,
+                                         const std::string &a_filename_prefix,
+                                         int a_normal_dir, double a_position,
+                                         int a_num_pixels, double a_min,
+                                         double a_max)
+    : m_var(a_var), m_var_type(a_var_type),
+      m_filename_prefix(a_filename_prefix), m_normal_dir(a_normal_dir),
+      m_position(a_position), m_num_pixels(a_num_pixels), m_min(a_min),
+      m_max(a_max)
+{
+    if (SpaceDim != 3 || m_normal_dir < 0 || m_normal_dir >= SpaceDim ||
+        m_num_pixels < 1)
+    {
+        MayDay::Error("InSituSliceRenderer: needs 3 dimensions, a normal "
+                      "direction of 0, 1 or 2 and at least one pixel");
+    }
+}
+
+void InSituSliceRenderer::operator()(const InSituData &a_data) const
+{
+    CH_TIME("InSituSliceRenderer");
+
+    // the in-plane directions
+    const int dir0 = (m_normal_dir + 1) % SpaceDim;
+    const int dir1 = (m_normal_dir + 2) % SpaceDim;
+
+    const InSituData::level_t &coarsest_level = a_data.levels[0];
+    const Box coarsest_domain_box =
+        coarsest_level.grids->physDomain().domainBox();
+    const double pixel_size =
+        coarsest_domain_box.size(dir0) * coarsest_level.dx / m_num_pixels;
+    const int width = m_num_pixels;
+    const int height = std::max(
+        1, int(std::round(coarsest_domain_box.size(dir1) * coarsest_level.dx /
+                          pixel_size)));
+
+    // the finest level with a local cell at each pixel and its value
+    std::vector<int> pixel_levels(width * height, -1);
+    std::vector<double> pixel_values(width * height, 0.);
+    for (const InSituData::level_t &level : a_data.levels)
+    {
+        const GRLevelData *data = (m_var_type == VariableType::evolution)
+                                      ? level.state
+                                      : level.diagnostics;
+        if (data == nullptr)
+            MayDay::Error("InSituSliceRenderer: there are no diagnostic vars");
+
+        const Box domain_box = level.grids->physDomain().domainBox();
+        const int normal_index =
+            std::min(std::max(int(std::floor(m_position / level.dx)),
+                              domain_box.smallEnd(m_normal_dir)),
+                     domain_box.bigEnd(m_normal_dir));
+
+        DataIterator dit = level.grids->dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+        {
+            const Box &box = (*level.grids)[dit];
+            if (normal_index < box.smallEnd(m_normal_dir) ||
+                normal_index > box.bigEnd(m_normal_dir))
+                continue;
+
+            // the pixels whose centres may be in this box
+            const int lo0 = std::max(
+                0, int(std::floor(box.smallEnd(dir0) * level.dx / pixel_size)));
+            const int hi0 = std::min(
+                width - 1,
+                int(std::ceil((box.bigEnd(dir0) + 1) * level.dx / pixel_size)));
+            const int lo1 = std::max(
+                0, int(std::floor(box.smallEnd(dir1) * level.dx / pixel_size)));
+            const int hi1 = std::min(
+                height - 1,
+                int(std::ceil((box.bigEnd(dir1) + 1) * level.dx / pixel_size)));
+
+            const FArrayBox &fab = (*data)[dit];
+            IntVect iv;
+            iv[m_normal_dir] = normal_index;
+            for (int p1 = lo1; p1 <= hi1; ++p1)
+            {
+                iv[dir1] = std::floor((p1 + 0.5) * pixel_size / level.dx);
+                for (int p0 = lo0; p0 <= hi0; ++p0)
+                {
+                    iv[dir0] = std::floor((p0 + 0.5) * pixel_size / level.dx);
+                    if (!box.contains(iv))
+                        continue;
+                    pixel_levels[p0 + width * p1] = level.level;
+                    pixel_values[p0 + width * p1] = fab(iv, m_var);
+                }
+            }
+        }
+    }
+
+    // keep only the values of the finest level over all ranks (each cell of
+    // a level is on exactly one rank)
+#ifdef CH_MPI
+    std::vector<int> finest_levels = pixel_levels;
+    MPI_Allreduce(MPI_IN_PLACE, finest_levels.data(), finest_levels.size(),
+                  MPI_INT, MPI_MAX, Chombo_MPI::comm);
+    for (int ipixel = 0; ipixel < width * height; ++ipixel)
+    {
+        if (pixel_levels[ipixel] != finest_levels[ipixel])
+            pixel_values[ipixel] = 0.;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, pixel_values.data(), pixel_values.size(),
+                  MPI_DOUBLE, MPI_SUM, Chombo_MPI::comm);
+#endif
+
+    if (procID() != 0)
+        return;
+
+    double min = m_min;
+    double max = m_max;
+    if (min >= max)
+    {
+        const auto minmax =
+            std::minmax_element(pixel_values.begin(), pixel_values.end());
+        min = *minmax.first;
+        max = *minmax.second;
+        if (min >= max)
+            max = min + 1.;
+    }
+
+    // the rows of the image go from the top (the high end of dir1)
+    std::vector<unsigned char> rgb(3 * width * height);
+    for (int row = 0; row < height; ++row)
+    {
+        const int p1 = height - 1 - row;
+        for (int p0 = 0; p0 < width; ++p0)
+        {
+            const double value = (pixel_values[p0 + width * p1] - min) /
+                                 (max - min);
+            colour_map(std::min(std::max(value, 0.), 1.),
+                       &rgb[3 * (p0 + width * row)]);
+        }
+    }
+
+    std::ostringstream filename;
+    filename << m_filename_prefix << std::setw(s_filename_steps_width)
+             << std::setfill('0') << a_data.step << ".png";
+    write_png(filename.str(), width, height, rgb);
+}
+
+void InSituSliceRenderer::colour_map(double a_value, unsigned char *a_rgb)
+{
+    // blue (0) to white (0.5) to red (1)
+    const double red = std::min(1., 2. * a_value);
+    const double blue = std::min(1., 2. * (1. - a_value));
+    const double green = std::min(red, blue);
+    a_rgb[0] = static_cast<unsigned char>(std::round(255. * red));
+    a_rgb[1] = static_cast<unsigned char>(std::round(255. * green));
+    a_rgb[2] = static_cast<unsigned char>(std::round(255. * blue));
+}
+
+namespace
+{
+uint32_t crc32(const unsigned char *a_data, size_t a_size, uint32_t a_crc)
+{
+    static const std::array<uint32_t, 256> table = []() {
+        std::array<uint32_t, 256> t;
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    for (size_t i = 0; i < a_size; ++i)
+        a_crc = table[(a_crc ^ a_data[i]) & 0xff] ^ (a_crc >> 8);
+    return a_crc;
+}
+
+void append_uint32(std::vector<unsigned char> &a_bytes, uint32_t a_value)
+{
+    // big endian as PNG and zlib require
+    for (int shift = 24; shift >= 0; shift -= 8)
+        a_bytes.push_back((a_value >> shift) & 0xff);
+}
+
+void write_png_chunk(std::ofstream &a_file, const char *a_type,
+                     const std::vector<unsigned char> &a_data)
+{
+    std::vector<unsigned char> chunk;
+    append_uint32(chunk, a_data.size());
+    chunk.insert(chunk.end(), a_type, a_type + 4);
+    chunk.insert(chunk.end(), a_data.begin(), a_data.end());
+    // the CRC covers the type and the data
+    const uint32_t crc =
+        crc32(chunk.data() + 4, chunk.size() - 4, 0xffffffffu) ^ 0xffffffffu;
+    append_uint32(chunk, crc);
+    a_file.write(reinterpret_cast<const char *>(chunk.data()), chunk.size());
+}
+} // namespace
+
+void InSituSliceRenderer::write_png(const std::string &a_filename, int a_width,
+                                    int a_height,
+                                    const std::vector<unsigned char> &a_rgb)
+{
+    std::ofstream file(a_filename, std::ios::binary);
+    if (!file)
+        MayDay::Error("InSituSliceRenderer::write_png: error opening file");
+
+    const unsigned char signature[8] = {0x89, 'P',  'N',  'G',
+                                        '\r', '\n', 0x1a, '\n'};
+    file.write(reinterpret_cast<const char *>(signature), 8);
+
+    // 8 bits per channel, RGB, no interlacing
+    std::vector<unsigned char> header;
+    append_uint32(header, a_width);
+    append_uint32(header, a_height);
+    header.insert(header.end(), {8, 2, 0, 0, 0});
+    write_png_chunk(file, "IHDR", header);
+
+    // each row starts with its filter type (none)
+    const size_t row_size = 3 * size_t(a_width);
+    std::vector<unsigned char> raw;
+    raw.reserve((row_size + 1) * a_height);
+    for (int row = 0; row < a_height; ++row)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), a_rgb.begin() + row * row_size,
+                   a_rgb.begin() + (row + 1) * row_size);
+    }
+
+    // a zlib stream of stored (uncompressed) deflate blocks
+    const size_t max_block_size = 65535;
+    std::vector<unsigned char> image_data = {0x78, 0x01};
+    uint32_t adler_a = 1, adler_b = 0;
+    for (size_t start = 0; start < raw.size(); start += max_block_size)
+    {
+        const size_t size = std::min(max_block_size, raw.size() - start);
+        const bool last_block = (start + size == raw.size());
+        image_data.push_back(last_block ? 1 : 0);
+        image_data.push_back(size & 0xff);
+        image_data.push_back(size >> 8);
+        image_data.push_back(~size & 0xff);
+        image_data.push_back((~size >> 8) & 0xff);
+        image_data.insert(image_data.end(), raw.begin() + start,
+                          raw.begin() + start + size);
+        for (size_t i = start; i < start + size; ++i)
+        {
+            adler_a = (adler_a + raw[i]) % 65521;
+            adler_b = (adler_b + adler_a) % 65521;
+        }
+    }
+    append_uint32(image_data, (adler_b << 16) | adler_a);
+    write_png_chunk(file, "IDAT", image_data);
+    write_png_chunk(file, "IEND", {});
+}
@@ -0,0 +1,60 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef INSITUSLICERENDERER_HPP_
+#define INSITUSLICERENDERER_HPP_
+
+// Our includes
+#include "InSituAnalysis.hpp"
+#include "VariableType.hpp"
+
+// Other includes
+#include <string>
+#include <vector>
+
+/// An in-situ analysis (see GRAMR::add_in_situ_analysis) that renders a
+/// slice of one variable to a PNG image
+/**
+ * The slice is the plane normal to a_normal_dir at coordinate a_position
+ * (from the low end of the domain). Each pixel takes the value of the cell
+ * containing its centre on the finest level covering it. Values are mapped
+ * linearly from [a_min, a_max] (or the range on the slice if a_min >= a_max)
+ * to a blue-white-red colour map. The image is a_num_pixels wide along the
+ * first in-plane direction and is written by rank 0 to a_filename_prefix
+ * followed by the step number and ".png".
+ */
+class InSituSliceRenderer
+{
+  public:
+    InSituSliceRenderer(int a_var, VariableType a_var_type,
+                        const std::string &a_filename_prefix,
+                        int a_normal_dir, double a_position, int a_num_pixels,
+                        double a_min, double a_max);
+
+    void operator()(const InSituData &a_data) const;
+
+    //! Writes an 8-bit RGB image (a_rgb holds the rows from the top) to a
+    //! PNG file (uncompressed)
+    static void write_png(const std::string &a_filename, int a_width,
+                          int a_height,
+                          const std::vector<unsigned char> &a_rgb);
+
+  protected:
+    const int m_var;
+    const VariableType m_var_type;
+    const std::string m_filename_prefix;
+    const int m_normal_dir;
+    const double m_position;
+    const int m_num_pixels;
+    const double m_min;
+    const double m_max;
+
+    static const int s_filename_steps_width = 6;
+
+    //! Maps a_value in [0, 1] to a colour
+    static void colour_map(double a_value, unsigned char *a_rgb);
+};
+
+#endif /* INSITUSLICERENDERER_HPP_ */
@@ -0,0 +1,166 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+// Chombo includes
+#include "BoxIterator.H"
+#include "CH_Timer.H"
+#include "IntVectSet.H"
+#include "SPMD.H"
+
+// Our includes
+#include "InSituStatistics.hpp"
+#include "SmallDataIO.hpp"
+
+// Other includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+InSituStatistics::InSituStatistics(int a_var, VariableType a_var_type,
+                                   const std::string &a_filename_prefix,
+                                   int a_num_bins, double a_min, double a_max,
+                                   double a_restart_time)
+    : m_var(a_var), m_var_type(a_var_type),
+      m_filename_prefix(a_filename_prefix), m_num_bins(a_num_bins),
+      m_min(a_min), m_max(a_max), m_restart_time(a_restart_time),
+      m_first_write(true)
+{
+    if (m_num_bins < 1 || m_max <= m_min)
+    {
+        MayDay::Error("InSituStatistics: need at least one bin and a max "
+                      "larger than the min");
+    }
+}
+
+void InSituStatistics::operator()(const InSituData &a_data)
+{
+    CH_TIME("InSituStatistics");
+
+    sums_t sums;
+    sums.min = std::numeric_limits<double>::max();
+    sums.max = std::numeric_limits<double>::lowest();
+    sums.volume = 0.;
+    sums.sum = 0.;
+    sums.sum_sq = 0.;
+    sums.histogram.assign(m_num_bins, 0.);
+
+    const int num_levels = a_data.levels.size();
+    for (int ilevel = 0; ilevel < num_levels; ++ilevel)
+    {
+        const InSituData::level_t &level = a_data.levels[ilevel];
+        const GRLevelData *data = (m_var_type == VariableType::evolution)
+                                      ? level.state
+                                      : level.diagnostics;
+        if (data == nullptr)
+            MayDay::Error("InSituStatistics: there are no diagnostic vars");
+        const double cell_volume = std::pow(level.dx, SpaceDim);
+
+        // the finer level (in this level's index space) replaces the cells
+        // it covers
+        Vector<Box> covered_boxes;
+        if (ilevel + 1 < num_levels)
+        {
+            const DisjointBoxLayout &finer_grids =
+                *a_data.levels[ilevel + 1].grids;
+            LayoutIterator lit = finer_grids.layoutIterator();
+            for (lit.begin(); lit.ok(); ++lit)
+                covered_boxes.push_back(coarsen(finer_grids[lit],
+                                                level.ref_ratio));
+        }
+
+        DataIterator dit = level.grids->dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+        {
+            const Box &box = (*level.grids)[dit];
+            IntVectSet uncovered(box);
+            for (int ibox = 0; ibox < covered_boxes.size(); ++ibox)
+            {
+                if (covered_boxes[ibox].intersectsNotEmpty(box))
+                    uncovered -= covered_boxes[ibox];
+            }
+            const Vector<Box> regions = uncovered.boxes();
+            for (int iregion = 0; iregion < regions.size(); ++iregion)
+                add_region((*data)[dit], regions[iregion], cell_volume, sums);
+        }
+    }
+
+#ifdef CH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &sums.min, 1, MPI_DOUBLE, MPI_MIN,
+                  Chombo_MPI::comm);
+    MPI_Allreduce(MPI_IN_PLACE, &sums.max, 1, MPI_DOUBLE, MPI_MAX,
+                  Chombo_MPI::comm);
+    double totals[3] = {sums.volume, sums.sum, sums.sum_sq};
+    MPI_Allreduce(MPI_IN_PLACE, totals, 3, MPI_DOUBLE, MPI_SUM,
+                  Chombo_MPI::comm);
+    sums.volume = totals[0];
+    sums.sum = totals[1];
+    sums.sum_sq = totals[2];
+    MPI_Allreduce(MPI_IN_PLACE, sums.histogram.data(), m_num_bins, MPI_DOUBLE,
+                  MPI_SUM, Chombo_MPI::comm);
+#endif
+
+    const double mean = sums.sum / sums.volume;
+    const double rms = std::sqrt(sums.sum_sq / sums.volume);
+    for (double &bin_volume : sums.histogram)
+        bin_volume /= sums.volume;
+
+    const bool first_step = m_first_write && (m_restart_time == 0.);
+
+    SmallDataIO stats_file(m_filename_prefix + "_stats", a_data.dt,
+                           a_data.time, m_restart_time, SmallDataIO::APPEND,
+                           first_step);
+    if (m_first_write)
+        stats_file.remove_duplicate_time_data();
+    if (first_step)
+        stats_file.write_header_line({"min", "max", "mean", "rms"});
+    stats_file.write_time_data_line({sums.min, sums.max, mean, rms});
+
+    SmallDataIO histogram_file(m_filename_prefix + "_histogram", a_data.dt,
+                               a_data.time, m_restart_time,
+                               SmallDataIO::APPEND, first_step);
+    if (m_first_write)
+        histogram_file.remove_duplicate_time_data();
+    if (first_step)
+    {
+        // label each bin by its centre
+        const double bin_width = (m_max - m_min) / m_num_bins;
+        std::vector<std::string> header_strings(m_num_bins);
+        for (int ibin = 0; ibin < m_num_bins; ++ibin)
+        {
+            header_strings[ibin] =
+                std::to_string(m_min + (ibin + 0.5) * bin_width);
+        }
+        histogram_file.write_header_line(header_strings);
+    }
+    histogram_file.write_time_data_line(sums.histogram);
+
+    m_first_write = false;
+}
+
+void InSituStatistics::add_region(const FArrayBox &a_fab, const Box &a_region,
+                                  double a_cell_volume, sums_t &a_sums) const
+{
+    const double bin_width = (m_max - m_min) / m_num_bins;
+    for (BoxIterator bit(a_region); bit.ok(); ++bit)
+    {
+        const double value = a_fab(bit(), m_var);
+        a_sums.min = std::min(a_sums.min, value);
+        a_sums.max = std::max(a_sums.max, value);
+        a_sums.volume += a_cell_volume;
+        a_sums.sum += a_cell_volume * value;
+        a_sums.sum_sq += a_cell_volume * value * value;
+
+        // (compared before converting to avoid overflowing the int)
+        int ibin = 0;
+        if (value >= m_max)
+            ibin = m_num_bins - 1;
+        else if (value > m_min)
+            ibin = std::min(int((value - m_min) / bin_width), m_num_bins - 1);
+        a_sums.histogram[ibin] += a_cell_volume;
+    }
+}
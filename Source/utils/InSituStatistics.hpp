@@ -0,0 +1,61 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef INSITUSTATISTICS_HPP_
+#define INSITUSTATISTICS_HPP_
+
+// Our includes
+#include "InSituAnalysis.hpp"
+#include "VariableType.hpp"
+
+// Other includes
+#include <string>
+#include <vector>
+
+/// An in-situ analysis (see GRAMR::add_in_situ_analysis) that writes the
+/// statistics and a histogram of one variable
+/**
+ * Every cell not covered by a finer level is weighted by its volume. The
+ * min, max, mean and rms go to a_filename_prefix + "_stats.dat" and the
+ * fraction of the volume in each of a_num_bins equal bins between a_min and
+ * a_max (values outside are counted in the end bins) to a_filename_prefix
+ * + "_histogram.dat", one line per call in each file.
+ */
+class InSituStatistics
+{
+  public:
+    InSituStatistics(int a_var, VariableType a_var_type,
+                     const std::string &a_filename_prefix, int a_num_bins,
+                     double a_min, double a_max, double a_restart_time);
+
+    void operator()(const InSituData &a_data);
+
+  protected:
+    const int m_var;
+    const VariableType m_var_type;
+    const std::string m_filename_prefix;
+    const int m_num_bins;
+    const double m_min;
+    const double m_max;
+    const double m_restart_time;
+    bool m_first_write;
+
+    struct sums_t
+    {
+        double min;
+        double max;
+        double volume;
+        double sum;
+        double sum_sq;
+        std::vector<double> histogram; //!< the volume in each bin
+    };
+
+    //! Adds the cells of a_region of a_fab (of volume a_cell_volume) to
+    //! a_sums
+    void add_region(const FArrayBox &a_fab, const Box &a_region,
+                    double a_cell_volume, sums_t &a_sums) const;
+};
+
+#endif /* INSITUSTATISTICS_HPP_ */
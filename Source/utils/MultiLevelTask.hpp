@@ -10,16 +10,24 @@
 #include "GRAMRLevel.hpp"
 #include "Scheduler.H"
 
-#include <limits> // std::numeric_limits
+#include <limits>  // std::numeric_limits
+#include <utility> // std::pair
+#include <vector>
 
 //! This is just an interface for the AMR scheduler to call some GRAMRLevel (or
 //! any other Example specific level) function on every AMRLevel
 //! Satisfies syntax of Chombo's Scheduler such that it can be passed to GRAMR
 //! and be scheduled
+//! If the task has no dependency between levels (and does no MPI
+//! communication), it can instead be run concurrently on all boxes of all
+//! levels (by passing a function of the level and the DataIndex of the box)
+//! so that threads are not left idle on small levels. Note that any OpenMP
+//! parallel regions inside the function will then be run by a single thread.
 template <class level_t = GRAMRLevel>
 class MultiLevelTask : public Scheduler::PeriodicFunction
 {
     std::function<void(level_t *)> m_func;
+    std::function<void(level_t *, const DataIndex &)> m_box_func;
     bool m_reverse_levels;
 
     // Use default condstructor of PeriodicFunction
@@ -34,6 +42,12 @@ class MultiLevelTask : public Scheduler::PeriodicFunction
     {
     }
 
+    //! a_box_func is called concurrently on every box of every level
+    MultiLevelTask(std::function<void(level_t *, const DataIndex &)> a_box_func)
+        : m_box_func(a_box_func), m_reverse_levels(false)
+    {
+    }
+
     // required from Scheduler::PeriodicFunction
     virtual void setUp(AMR &a_AMR, int a_interval = -1) override
     {
@@ -52,8 +66,36 @@ class MultiLevelTask : public Scheduler::PeriodicFunction
         if (m_reverse_levels)
             std::reverse(std::begin(amr_level_ptrs), std::end(amr_level_ptrs));
 
-        for (AMRLevel *amr_level_ptr : amr_level_ptrs)
-            m_func(level_t::gr_cast(amr_level_ptr));
+        if (m_box_func)
+            run_on_boxes(amr_level_ptrs);
+        else
+        {
+            for (AMRLevel *amr_level_ptr : amr_level_ptrs)
+                m_func(level_t::gr_cast(amr_level_ptr));
+        }
+    }
+
+  private:
+    //! runs m_box_func on every (level, box) pair, sharing the boxes of all
+    //! levels between the threads
+    void run_on_boxes(const std::vector<AMRLevel *> &a_amr_level_ptrs)
+    {
+        std::vector<std::pair<level_t *, DataIndex>> work_items;
+        for (AMRLevel *amr_level_ptr : a_amr_level_ptrs)
+        {
+            level_t *level_ptr = level_t::gr_cast(amr_level_ptr);
+            DataIterator dit =
+                level_ptr->getLevelData().disjointBoxLayout().dataIterator();
+            for (dit.begin(); dit.ok(); ++dit)
+                work_items.emplace_back(level_ptr, dit());
+        }
+
+        const int num_items = work_items.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int item = 0; item < num_items; ++item)
+            m_box_func(work_items[item].first, work_items[item].second);
     }
 };
 
@@ -77,9 +119,17 @@ class MultiLevelTaskPtr : public RefCountedPtr<Scheduler>
           m_ptr_to_func(new MultiLevelTask<level_t>(a_func, a_reverse_levels))
     // the two 'new' pointers are deleted by RefCountedPtr, no memory leak
     {
-        if (a_interval <= 0) // the user probably means "never again"
-            a_interval = std::numeric_limits<int>::max();
-        (*this)->schedule(m_ptr_to_func, a_interval);
+        schedule_task(a_interval);
+    }
+
+    //! version for a function called concurrently on all boxes of all levels
+    MultiLevelTaskPtr(
+        std::function<void(level_t *, const DataIndex &)> a_box_func,
+        int a_interval = std::numeric_limits<int>::max())
+        : RefCountedPtr<Scheduler>(new Scheduler),
+          m_ptr_to_func(new MultiLevelTask<level_t>(a_box_func))
+    {
+        schedule_task(a_interval);
     }
 
     // run immediately!
@@ -88,6 +138,14 @@ class MultiLevelTaskPtr : public RefCountedPtr<Scheduler>
         m_ptr_to_func->setUp(amr);
         (*m_ptr_to_func)();
     }
+
+  private:
+    void schedule_task(int a_interval)
+    {
+        if (a_interval <= 0) // the user probably means "never again"
+            a_interval = std::numeric_limits<int>::max();
+        (*this)->schedule(m_ptr_to_func, a_interval);
+    }
 };
 
 #endif /* MULTILEVELTASK_HPP_ */
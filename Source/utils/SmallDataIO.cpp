@@ -4,10 +4,11 @@
  */
 
 // Chombo includes
-#include "SPMD.H" // for Chombo_MPI
+#include "SPMD.H" // for procID and broadcast
 
 // Other includes
 #include "SmallDataIO.hpp"
+#include "SmallDataIOBuffer.hpp"
 #include <cmath>
 #include <random>
 // (MR): if it were up to me, I'd be using the C++17 filesystems library
@@ -42,11 +43,16 @@ SmallDataIO::SmallDataIO(std::string a_filename_prefix, double a_dt,
       m_coords_width(m_coords_precision + 5),
       m_coords_epsilon(std::pow(10.0, -a_coords_precision))
 {
-#ifdef CH_MPI
-    MPI_Comm_rank(Chombo_MPI::comm, &m_rank);
-#else
-    m_rank = 0;
-#endif
+    // procID() is cached by Chombo so this is safe to call from a thread
+    // other than the main one (e.g. in an AsyncTaskQueue task)
+    m_rank = procID();
+    // in the first step after a restart the file is written directly so that
+    // any duplicate time data can be removed
+    const bool restart_step =
+        (m_mode == APPEND && !m_first_step && m_restart_time > 0. &&
+         m_time < m_restart_time + m_dt + m_coords_epsilon);
+    m_buffered =
+        (m_mode != READ && !restart_step && SmallDataIOBuffer::is_active());
     if (m_rank == 0)
     {
         std::ios::openmode file_openmode;
@@ -57,8 +63,7 @@ SmallDataIO::SmallDataIO(std::string a_filename_prefix, double a_dt,
                 // overwrite any existing file if this is the first step
                 file_openmode = std::ios::out;
             }
-            else if (m_restart_time > 0. &&
-                     m_time < m_restart_time + m_dt + m_coords_epsilon)
+            else if (restart_step)
             {
                 // allow reading in the restart case so that duplicate time
                 // data may be removed
@@ -85,6 +90,10 @@ SmallDataIO::SmallDataIO(std::string a_filename_prefix, double a_dt,
         {
             MayDay::Error("SmallDataIO: mode not supported");
         }
+        if (m_buffered)
+            return;
+        // anything still buffered goes before what is written directly
+        SmallDataIOBuffer::flush(m_filename);
         m_file.open(m_filename, file_openmode);
         if (!m_file)
         {
@@ -116,7 +125,20 @@ SmallDataIO::~SmallDataIO()
 {
     if (m_rank == 0)
     {
-        m_file.close();
+        if (m_buffered)
+        {
+            SmallDataIOBuffer::append(m_filename, m_buffer.str(),
+                                      m_mode == NEW || m_first_step,
+                                      m_mode == APPEND);
+        }
+        else
+        {
+            m_file.close();
+            // record the size of files written directly too (e.g. so that a
+            // nan rollback can remove the output of the discarded steps)
+            if (m_mode == APPEND && SmallDataIOBuffer::is_active())
+                SmallDataIOBuffer::append(m_filename, "", false, true);
+        }
     }
 }
 
@@ -140,27 +162,28 @@ void SmallDataIO::write_header_line(
 {
     if (m_rank == 0)
     {
+        std::ostream &out = output_stream();
         // all header lines start with a '#'.
-        m_file << "#";
+        out << "#";
         for (int istr = 0; istr < a_pre_header_strings.size(); ++istr)
         {
             // first column header is shorter due to preceeding #
             if (istr == 0)
             {
-                m_file << std::setw(m_coords_width - 1)
-                       << a_pre_header_strings[istr];
+                out << std::setw(m_coords_width - 1)
+                    << a_pre_header_strings[istr];
             }
             else
             {
-                m_file << std::setw(m_coords_width)
-                       << a_pre_header_strings[istr];
+                out << std::setw(m_coords_width)
+                    << a_pre_header_strings[istr];
             }
         }
         for (std::string header_item : a_header_strings)
         {
-            m_file << std::setw(m_data_width) << header_item;
+            out << std::setw(m_data_width) << header_item;
         }
-        m_file << "\n";
+        out << "\n";
     }
 }
 
@@ -181,17 +204,18 @@ void SmallDataIO::write_data_line(const std::vector<double> &a_data,
 {
     if (m_rank == 0)
     {
-        m_file << std::fixed << std::setprecision(m_coords_precision);
+        std::ostream &out = output_stream();
+        out << std::fixed << std::setprecision(m_coords_precision);
         for (double coord : a_coords)
         {
-            m_file << std::setw(m_coords_width) << coord;
+            out << std::setw(m_coords_width) << coord;
         }
-        m_file << std::scientific << std::setprecision(m_data_precision);
+        out << std::scientific << std::setprecision(m_data_precision);
         for (double data : a_data)
         {
-            m_file << std::setw(m_data_width) << data;
+            out << std::setw(m_data_width) << data;
         }
-        m_file << "\n";
+        out << "\n";
     }
 }
 
@@ -199,14 +223,17 @@ void SmallDataIO::line_break()
 {
     if (m_rank == 0)
     {
-        m_file << "\n\n";
+        std::ostream &out = output_stream();
+        out << "\n\n";
     }
 }
 
 void SmallDataIO::remove_duplicate_time_data(const bool keep_m_time_data)
 {
+    // nothing to remove if the file was truncated to the restart checkpoint
     if (m_rank == 0 && m_restart_time > 0. && m_mode == APPEND &&
-        m_time < m_restart_time + m_dt + m_coords_epsilon)
+        m_time < m_restart_time + m_dt + m_coords_epsilon &&
+        !SmallDataIOBuffer::was_truncated(m_filename))
     {
         // copy lines with time < m_time into a temporary file
         m_file.seekg(0);
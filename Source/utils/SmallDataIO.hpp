@@ -7,6 +7,7 @@
 #define SMALLDATAIO_HPP_
 
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -49,6 +50,17 @@ class SmallDataIO
 
     std::fstream m_file;
     int m_rank; // only rank 0 does the write out
+    //! whether the output goes to SmallDataIOBuffer (via m_buffer) rather
+    //! than straight to m_file
+    bool m_buffered;
+    std::ostringstream m_buffer;
+
+    std::ostream &output_stream()
+    {
+        if (m_buffered)
+            return m_buffer;
+        return m_file;
+    }
 
   public:
     //! Constructor (opens file)
@@ -0,0 +1,263 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+// Chombo includes
+#include "CH_Timer.H"
+#include "MayDay.H"
+#include "SPMD.H"
+
+// Our includes
+#include "SmallDataIOBuffer.hpp"
+
+// Other includes
+#include <fstream>
+#include <sstream>
+#include <unistd.h> // for truncate
+#include <vector>
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+std::mutex SmallDataIOBuffer::s_mutex;
+int SmallDataIOBuffer::s_flush_interval = 0;
+bool SmallDataIOBuffer::s_hold = false;
+bool SmallDataIOBuffer::s_flush_due = false;
+int SmallDataIOBuffer::s_num_steps = 0;
+std::map<std::string, SmallDataIOBuffer::file_t> SmallDataIOBuffer::s_files;
+
+void SmallDataIOBuffer::set_flush_interval(int a_interval)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_flush_interval = a_interval;
+}
+
+void SmallDataIOBuffer::set_hold_output(bool a_hold)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_hold = a_hold;
+}
+
+bool SmallDataIOBuffer::is_active()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_flush_interval > 0 || s_hold;
+}
+
+void SmallDataIOBuffer::append(const std::string &a_filename,
+                               const std::string &a_data, bool a_overwrite,
+                               bool a_record_size)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    file_t &file = s_files[a_filename];
+    if (a_overwrite)
+    {
+        file.pending.clear();
+        file.overwrite = true;
+    }
+    file.record_size = a_record_size;
+    file.pending += a_data;
+}
+
+void SmallDataIOBuffer::flush(const std::string &a_filename)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto file_it = s_files.find(a_filename);
+    if (file_it != s_files.end())
+        flush_file(file_it);
+}
+
+void SmallDataIOBuffer::flush()
+{
+    CH_TIME("SmallDataIOBuffer::flush");
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (auto file_it = s_files.begin(); file_it != s_files.end();)
+        flush_file(file_it);
+}
+
+void SmallDataIOBuffer::step_finished()
+{
+    bool flush_now;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        ++s_num_steps;
+        // held output without a flush interval is written every step
+        flush_now = (s_flush_interval > 0)
+                        ? (s_num_steps % s_flush_interval == 0)
+                        : s_hold;
+        if (s_hold)
+        {
+            s_flush_due = s_flush_due || flush_now;
+            flush_now = false;
+        }
+    }
+    if (flush_now)
+        flush();
+}
+
+void SmallDataIOBuffer::step_accepted()
+{
+    bool flush_now;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        flush_now = s_flush_due;
+        s_flush_due = false;
+    }
+    if (flush_now)
+        flush();
+}
+
+std::map<std::string, long long> SmallDataIOBuffer::get_file_sizes()
+{
+    if (!is_active())
+        return {};
+    flush();
+
+    // "filename\nsize\n" for each file (filenames have no newlines). The
+    // size is taken from the file as it may also have been written directly
+    // (e.g. at the first step after a restart).
+    std::string sizes_string;
+    if (procID() == 0)
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        std::ostringstream sizes_ss;
+        for (const auto &file : s_files)
+        {
+            if (!file.second.record_size)
+                continue;
+            std::ifstream existing_file(file.first,
+                                        std::ios::binary | std::ios::ate);
+            if (existing_file)
+            {
+                sizes_ss << file.first << "\n"
+                         << static_cast<long long>(existing_file.tellg())
+                         << "\n";
+            }
+        }
+        sizes_string = sizes_ss.str();
+    }
+#ifdef CH_MPI
+    int length = sizes_string.size();
+    MPI_Bcast(&length, 1, MPI_INT, 0, Chombo_MPI::comm);
+    std::vector<char> chars(sizes_string.begin(), sizes_string.end());
+    chars.resize(length);
+    MPI_Bcast(chars.data(), length, MPI_CHAR, 0, Chombo_MPI::comm);
+    sizes_string.assign(chars.begin(), chars.end());
+#endif
+
+    std::map<std::string, long long> sizes;
+    std::istringstream sizes_ss(sizes_string);
+    std::string filename, size;
+    while (std::getline(sizes_ss, filename) && std::getline(sizes_ss, size))
+        sizes[filename] = std::stoll(size);
+    return sizes;
+}
+
+std::map<std::string, long long> SmallDataIOBuffer::get_output_sizes()
+{
+    std::map<std::string, long long> sizes;
+    if (procID() != 0)
+        return sizes;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (const auto &file : s_files)
+    {
+        if (!file.second.record_size)
+            continue;
+        const long long written_size =
+            file.second.overwrite ? 0 : file_size(file.first);
+        sizes[file.first] = written_size + file.second.pending.size();
+    }
+    return sizes;
+}
+
+void SmallDataIOBuffer::discard_output(
+    const std::map<std::string, long long> &a_sizes)
+{
+    if (procID() != 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (auto &file : s_files)
+    {
+        if (!file.second.record_size)
+            continue;
+        auto size_it = a_sizes.find(file.first);
+        const long long size = (size_it != a_sizes.end()) ? size_it->second : 0;
+        const long long written_size =
+            file.second.overwrite ? 0 : file_size(file.first);
+        if (written_size > size)
+        {
+            // some of the discarded output has been written already
+            if (truncate(file.first.c_str(), size) != 0)
+            {
+                MayDay::Error("SmallDataIOBuffer::discard_output: error "
+                              "truncating file");
+            }
+            file.second.pending.clear();
+        }
+        else
+            file.second.pending.resize(size - written_size);
+    }
+}
+
+void SmallDataIOBuffer::truncate_files(
+    const std::map<std::string, long long> &a_sizes)
+{
+    if (procID() != 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (const auto &size : a_sizes)
+    {
+        // anything after the checkpoint was written by the previous run
+        // after it and will be written again
+        if (file_size(size.first) > size.second)
+        {
+            if (truncate(size.first.c_str(), size.second) != 0)
+            {
+                MayDay::Error("SmallDataIOBuffer::truncate_files: error "
+                              "truncating file");
+            }
+        }
+        file_t &file = s_files[size.first];
+        file.record_size = true;
+        file.truncated = true;
+    }
+}
+
+bool SmallDataIOBuffer::was_truncated(const std::string &a_filename)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto file_it = s_files.find(a_filename);
+    return file_it != s_files.end() && file_it->second.truncated;
+}
+
+long long SmallDataIOBuffer::file_size(const std::string &a_filename)
+{
+    std::ifstream file(a_filename, std::ios::binary | std::ios::ate);
+    return file ? static_cast<long long>(file.tellg()) : 0;
+}
+
+void SmallDataIOBuffer::flush_file(
+    std::map<std::string, file_t>::iterator &a_file_it)
+{
+    file_t &file = a_file_it->second;
+    if (!file.pending.empty() || file.overwrite)
+    {
+        std::ofstream out_file(a_file_it->first, file.overwrite
+                                                     ? std::ios::out
+                                                     : std::ios::app);
+        if (!out_file)
+            MayDay::Error("SmallDataIOBuffer::flush: error opening file");
+        out_file << file.pending;
+        file.pending.clear();
+        file.overwrite = false;
+    }
+
+    if (file.record_size)
+        ++a_file_it;
+    else
+        a_file_it = s_files.erase(a_file_it);
+}
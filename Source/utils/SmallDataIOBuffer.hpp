@@ -0,0 +1,107 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef SMALLDATAIOBUFFER_HPP_
+#define SMALLDATAIOBUFFER_HPP_
+
+// Other includes
+#include <map>
+#include <mutex>
+#include <string>
+
+/// Holds the output of SmallDataIO in memory between flushes
+/**
+ * If a flush interval is set (see small_data_flush_interval), SmallDataIO
+ * appends what it would write to a file to the pending output of that file
+ * here instead, and all pending output is written in one go every
+ * flush interval coarse steps, at every checkpoint and at the end of the run.
+ * The files end up with the same content. Each checkpoint records how long
+ * every file written in APPEND mode was at that time so that on restart the
+ * files are truncated back to the checkpoint rather than rewritten. If the
+ * output is held (see set_hold_output), nothing is written until the step is
+ * accepted and the output of a rolled back step can be discarded. All
+ * functions are thread safe as SmallDataIO may be used from an
+ * AsyncTaskQueue. Only rank 0 has any pending output.
+ */
+class SmallDataIOBuffer
+{
+  public:
+    //! Buffer the output and flush it every a_interval coarse steps (0 means
+    //! no buffering)
+    static void set_flush_interval(int a_interval);
+
+    //! Hold all output in memory until step_accepted() (even if no flush
+    //! interval is set) so that the output of a step that is rolled back
+    //! never reaches the files
+    static void set_hold_output(bool a_hold);
+
+    //! Whether SmallDataIO output goes here (a flush interval is set or the
+    //! output is held)
+    static bool is_active();
+
+    //! Appends a_data to the pending output of a_filename. If a_overwrite,
+    //! any existing file (and pending output) is replaced. Only the sizes of
+    //! files with a_record_size are recorded in checkpoints.
+    static void append(const std::string &a_filename, const std::string &a_data,
+                       bool a_overwrite, bool a_record_size);
+
+    //! Writes the pending output of a_filename
+    static void flush(const std::string &a_filename);
+
+    //! Writes all pending output
+    static void flush();
+
+    //! Called at the end of every coarse step; flushes every flush interval
+    //! (or, if the output is held, at the next step_accepted())
+    static void step_finished();
+
+    //! Called once a coarse step is known not to be rolled back
+    static void step_accepted();
+
+    //! Flushes and returns the size of every recorded file on rank 0 (the
+    //! same on all ranks, collective). Nothing is recorded unless active.
+    static std::map<std::string, long long> get_file_sizes();
+
+    //! Truncates the files to the sizes recorded in a checkpoint (on rank 0)
+    static void truncate_files(const std::map<std::string, long long> &a_sizes);
+
+    //! The size of every recorded file including its pending output (on rank
+    //! 0, empty elsewhere). Nothing is written.
+    static std::map<std::string, long long> get_output_sizes();
+
+    //! Discards any output (written or pending) beyond a_sizes, as returned
+    //! by get_output_sizes(), and all output of recorded files not in a_sizes
+    //! (on rank 0)
+    static void discard_output(const std::map<std::string, long long> &a_sizes);
+
+    //! Returns true if a_filename was truncated to the restart checkpoint (so
+    //! it contains no data after it)
+    static bool was_truncated(const std::string &a_filename);
+
+  private:
+    struct file_t
+    {
+        std::string pending;      //!< output not yet written
+        bool overwrite = false;   //!< replace the file at the next flush
+        bool record_size = false; //!< whether the size goes in checkpoints
+        bool truncated = false;   //!< truncated to the restart checkpoint
+    };
+
+    static std::mutex s_mutex;
+    static int s_flush_interval;
+    static bool s_hold;
+    static bool s_flush_due; //!< a flush is due at the next step_accepted()
+    static int s_num_steps;
+    static std::map<std::string, file_t> s_files;
+
+    //! The size of a_filename on disk (0 if it does not exist)
+    static long long file_size(const std::string &a_filename);
+
+    //! Writes the pending output of a_file and forgets files whose size is
+    //! not recorded (s_mutex must be locked)
+    static void flush_file(std::map<std::string, file_t>::iterator &a_file_it);
+};
+
+#endif /* SMALLDATAIOBUFFER_HPP_ */
@@ -44,6 +44,14 @@ class WeylExtraction : public SphericalExtraction
         // extract the values of the Weyl scalars on the spheres
         extract(a_interpolator);
 
+        process_extraction();
+    }
+
+    //! Write the extracted data (if requested) and compute and write the mode
+    //! integrals. This does no MPI communication so can be deferred (e.g.
+    //! using an AsyncTaskQueue) after extract has been called
+    void process_extraction()
+    {
         if (m_params.write_extraction)
             write_extraction(m_params.extraction_file_prefix);
 
@@ -113,6 +113,30 @@ int runInterpolatorTest(int argc, char *argv[])
         status |= (abs(B_dx[ipoint] - value_B_dx) > 1e-10);
     }
 
+    // Filling only the ghosts the query needs (after losing all of them)
+    // must give exactly the same values as filling all of them in refresh
+    for (GRAMRLevel *level : gr_amr.get_gramrlevels())
+        static_cast<InterpolatorTestLevel *>(level)->loseGhosts();
+    std::vector<double> A_on_demand(num_points);
+    std::vector<double> B_on_demand(num_points);
+    std::vector<double> B_dx_on_demand(num_points);
+    InterpolationQuery query_on_demand(num_points);
+    query_on_demand.setCoords(0, interp_x.data())
+        .setCoords(1, interp_y.data())
+        .setCoords(2, interp_z.data())
+        .addComp(c_A, A_on_demand.data())
+        .addComp(c_B, B_on_demand.data())
+        .addComp(c_B, B_dx_on_demand.data(), Derivative::dx);
+    interpolator.refresh_on_demand();
+    interpolator.interp(query_on_demand);
+
+    for (int ipoint = 0; ipoint < num_points; ++ipoint)
+    {
+        status |= (A_on_demand[ipoint] != A[ipoint]) << 1;
+        status |= (B_on_demand[ipoint] != B[ipoint]) << 1;
+        status |= (B_dx_on_demand[ipoint] != B_dx[ipoint]) << 1;
+    }
+
     return status;
 }
 
@@ -10,6 +10,7 @@
 #include "GRAMRLevel.hpp"
 #include "Polynomial.hpp"
 #include "SetValue.hpp"
+#include <cmath>
 
 class InterpolatorTestLevel : public GRAMRLevel
 {
@@ -31,6 +32,24 @@ class InterpolatorTestLevel : public GRAMRLevel
 
     virtual void computeTaggingCriterion(FArrayBox &tagging_criterion,
                                          const FArrayBox &current_state){};
+
+  public:
+    // overwrite the ghosts inside the domain (which an exchange fills) as if
+    // they had not been filled
+    void loseGhosts()
+    {
+        DataIterator dit = m_state_new.dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+        {
+            FArrayBox &state = m_state_new[dit];
+            FArrayBox valid(m_grids[dit], NUM_VARS);
+            valid.copy(state);
+            state.setVal(std::nan(""),
+                         state.box() & m_problem_domain.domainBox(), 0,
+                         NUM_VARS);
+            state.copy(valid);
+        }
+    }
 };
 
 #endif /* INTERPOLATORTESTLEVEL_HPP_ */
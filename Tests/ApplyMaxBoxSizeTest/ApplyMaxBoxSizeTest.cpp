@@ -0,0 +1,111 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to LICENSE, in Chombo's root directory.
+ */
+#endif
+
+// Chombo includes
+#include "parstream.H" //Gives us pout()
+
+// General includes:
+#include <iostream>
+#include <vector>
+
+using std::endl;
+#include "GRAMR.hpp"
+
+#include "GRParmParse.hpp"
+#include "SetupFunctions.hpp"
+#include "SimulationParameters.hpp"
+
+// Problem specific includes:
+#include "ApplyMaxBoxSizeTestLevel.hpp"
+#include "DefaultLevelFactory.hpp"
+#include "UserVariables.hpp"
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+int runApplyMaxBoxSizeTest(int argc, char *argv[])
+{
+    // Load the parameter file and construct the SimulationParameter class
+    // To add more parameters edit the SimulationParameters file.
+    std::string in_string = argv[argc - 1];
+    pout() << in_string << std::endl;
+    char const *in_file = argv[argc - 1];
+    GRParmParse pp(0, argv + argc, NULL, in_file);
+    SimulationParameters sim_params(pp);
+
+    GRAMR gr_amr;
+    DefaultLevelFactory<ApplyMaxBoxSizeTestLevel> apply_max_box_size_test_fact(
+        gr_amr, sim_params);
+    setupAMRObject(gr_amr, apply_max_box_size_test_fact);
+
+    std::vector<ApplyMaxBoxSizeTestLevel *> levels;
+    for (GRAMRLevel *level : gr_amr.get_gramrlevels())
+        levels.push_back(static_cast<ApplyMaxBoxSizeTestLevel *>(level));
+    const int finest_level = gr_amr.get_finest_level();
+
+    int status = 0;
+    if (finest_level < 1)
+    {
+        pout() << "expected at least 2 levels but there are "
+               << finest_level + 1 << endl;
+        return 1;
+    }
+
+    std::vector<int> num_boxes;
+    for (int ilevel = 0; ilevel <= finest_level; ++ilevel)
+        num_boxes.push_back(levels[ilevel]->boxes().size());
+
+    // split the boxes of every level (as autotune_apply does)
+    gr_amr.apply_max_box_size(sim_params.new_max_box_size);
+
+    for (int ilevel = 0; ilevel <= finest_level; ++ilevel)
+    {
+        if (levels[ilevel]->boxes().size() <= num_boxes[ilevel])
+        {
+            pout() << "level " << ilevel << ": the boxes were not split"
+                   << endl;
+            status |= 2;
+        }
+        double max_error = levels[ilevel]->maxError();
+#ifdef CH_MPI
+        MPI_Allreduce(MPI_IN_PLACE, &max_error, 1, MPI_DOUBLE, MPI_MAX,
+                      Chombo_MPI::comm);
+#endif
+        pout() << "level " << ilevel
+               << ": max error on the valid cells and boundary ghosts = "
+               << max_error << endl;
+        // all the data is kept rather than interpolated
+        if (max_error != 0.)
+            status |= 4;
+    }
+
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    mainSetup(argc, argv);
+
+    int status = runApplyMaxBoxSizeTest(argc, argv);
+
+    if (status == 0)
+        pout() << "ApplyMaxBoxSize test passed." << endl;
+    else
+        pout() << "ApplyMaxBoxSize test failed with return code " << status
+               << endl;
+
+    mainFinalize();
+    return status;
+}
@@ -0,0 +1,97 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef APPLYMAXBOXSIZETESTLEVEL_HPP_
+#define APPLYMAXBOXSIZETESTLEVEL_HPP_
+
+#include "BoxIterator.H"
+#include "GRAMRLevel.hpp"
+#include "UserVariables.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+class ApplyMaxBoxSizeTestLevel : public GRAMRLevel
+{
+    friend class DefaultLevelFactory<ApplyMaxBoxSizeTestLevel>;
+    // Inherit the contructors from GRAMRLevel
+    using GRAMRLevel::GRAMRLevel;
+
+    // A value which interpolation does not reproduce exactly
+    double value(const IntVect &a_iv, int a_comp) const
+    {
+        double value = 1. + a_comp;
+        for (int dir = 0; dir < SpaceDim; ++dir)
+            value *= std::sin(0.3 * (a_iv[dir] + 0.5) * m_dx + dir);
+        return value;
+    }
+
+    // all cells, including the boundary ghosts (which Sommerfeld BCs do not
+    // fill)
+    virtual void initialData()
+    {
+        DataIterator dit = m_state_new.dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+        {
+            FArrayBox &state = m_state_new[dit];
+            for (int comp = 0; comp < NUM_VARS; ++comp)
+            {
+                for (BoxIterator bit(state.box()); bit.ok(); ++bit)
+                    state(bit(), comp) = value(bit(), comp);
+            }
+        }
+    }
+
+    // nothing is evolved
+    virtual void specificEvalRHS(GRLevelData &a_soln, GRLevelData &a_rhs,
+                                 const double a_time)
+    {
+        a_rhs.setVal(0.);
+    }
+
+    // refine everywhere so that the finer level also has boundary ghosts
+    virtual void computeTaggingCriterion(FArrayBox &tagging_criterion,
+                                         const FArrayBox &current_state)
+    {
+        tagging_criterion.setVal(1.);
+    }
+
+  public:
+    // the max difference from the initial data on the valid cells and the
+    // boundary ghosts of the local boxes
+    double maxError() const
+    {
+        const Box &domain_box = m_problem_domain.domainBox();
+        double max_error = 0.;
+        DataIterator dit = m_state_new.dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+        {
+            Box box = m_grids[dit];
+            for (int dir = 0; dir < SpaceDim; ++dir)
+            {
+                if (box.smallEnd(dir) == domain_box.smallEnd(dir))
+                    box.growLo(dir, m_num_ghosts);
+                if (box.bigEnd(dir) == domain_box.bigEnd(dir))
+                    box.growHi(dir, m_num_ghosts);
+            }
+            const FArrayBox &state = m_state_new[dit];
+            for (int comp = 0; comp < NUM_VARS; ++comp)
+            {
+                for (BoxIterator bit(box); bit.ok(); ++bit)
+                {
+                    const double error =
+                        std::abs(state(bit(), comp) - value(bit(), comp));
+                    // a nan (e.g. unset memory) is as bad as it gets
+                    max_error = std::isnan(error)
+                                    ? std::numeric_limits<double>::max()
+                                    : std::max(max_error, error);
+                }
+            }
+        }
+        return max_error;
+    }
+};
+
+#endif /* APPLYMAXBOXSIZETESTLEVEL_HPP_ */
@@ -0,0 +1,24 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef SIMULATIONPARAMETERS_HPP_
+#define SIMULATIONPARAMETERS_HPP_
+
+// General includes
+#include "ChomboParameters.hpp"
+#include "GRParmParse.hpp"
+
+class SimulationParameters : public ChomboParameters
+{
+  public:
+    SimulationParameters(GRParmParse &pp) : ChomboParameters(pp)
+    {
+        pp.load("new_max_box_size", new_max_box_size, max_grid_size / 2);
+    }
+
+    int new_max_box_size; // the max box size the levels are split into
+};
+
+#endif /* SIMULATIONPARAMETERS_HPP_ */
@@ -0,0 +1,132 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to LICENSE, in Chombo's root directory.
+ */
+#endif
+
+// Chombo includes
+#include "parstream.H" //Gives us pout()
+
+// General includes:
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using std::endl;
+#include "GRAMR.hpp"
+
+#include "GRParmParse.hpp"
+#include "SetupFunctions.hpp"
+#include "SimulationParameters.hpp"
+
+// Problem specific includes:
+#include "CoarseFineGhostCacheTestLevel.hpp"
+#include "DefaultLevelFactory.hpp"
+#include "UserVariables.hpp"
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+int runCoarseFineGhostCacheTest(int argc, char *argv[])
+{
+    // Load the parameter file and construct the SimulationParameter class
+    // To add more parameters edit the SimulationParameters file.
+    std::string in_string = argv[argc - 1];
+    pout() << in_string << std::endl;
+    char const *in_file = argv[argc - 1];
+    GRParmParse pp(0, argv + argc, NULL, in_file);
+    SimulationParameters sim_params(pp);
+
+    GRAMR gr_amr;
+    DefaultLevelFactory<CoarseFineGhostCacheTestLevel>
+        coarse_fine_ghost_cache_test_fact(gr_amr, sim_params);
+    setupAMRObject(gr_amr, coarse_fine_ghost_cache_test_fact);
+
+    std::vector<CoarseFineGhostCacheTestLevel *> levels;
+    for (GRAMRLevel *level : gr_amr.get_gramrlevels())
+        levels.push_back(static_cast<CoarseFineGhostCacheTestLevel *>(level));
+    const int finest_level = gr_amr.get_finest_level();
+
+    if (finest_level < 2)
+    {
+        pout() << "expected at least 3 levels but there are "
+               << finest_level + 1 << endl;
+        return 1;
+    }
+
+    // evolve from the same initial data with and without the cache
+    gr_amr.write_memory_checkpoint();
+    std::vector<std::vector<double>> cached_data(finest_level + 1);
+    for (int ilevel = 0; ilevel <= finest_level; ++ilevel)
+        levels[ilevel]->setCacheCoarseFineGhosts(true);
+    gr_amr.run(sim_params.stop_time, sim_params.max_steps);
+    for (int ilevel = 0; ilevel <= finest_level; ++ilevel)
+        cached_data[ilevel] = levels[ilevel]->validData();
+
+    gr_amr.read_memory_checkpoint();
+    for (int ilevel = 0; ilevel <= finest_level; ++ilevel)
+        levels[ilevel]->setCacheCoarseFineGhosts(false);
+    gr_amr.run(sim_params.stop_time, sim_params.max_steps);
+
+    int status = 0;
+    if (levels[0]->time() <= 0.)
+    {
+        pout() << "the hierarchy was not evolved" << endl;
+        status |= 2;
+    }
+    for (int ilevel = 0; ilevel <= finest_level; ++ilevel)
+    {
+        const std::vector<double> uncached_data = levels[ilevel]->validData();
+        double max_diff = 0.;
+        if (uncached_data.size() != cached_data[ilevel].size())
+            max_diff = std::numeric_limits<double>::max();
+        for (int i = 0; i < uncached_data.size() && max_diff == 0.; ++i)
+        {
+            const double diff =
+                std::abs(uncached_data[i] - cached_data[ilevel][i]);
+            // a nan is as bad as it gets
+            max_diff = std::isnan(diff) ? std::numeric_limits<double>::max()
+                                        : std::max(max_diff, diff);
+        }
+#ifdef CH_MPI
+        MPI_Allreduce(MPI_IN_PLACE, &max_diff, 1, MPI_DOUBLE, MPI_MAX,
+                      Chombo_MPI::comm);
+#endif
+        pout() << "level " << ilevel
+               << ": max difference with and without the cache = "
+               << max_diff << endl;
+        // the cached ghosts are copies of the interpolated ones
+        if (max_diff != 0.)
+            status |= 4;
+    }
+
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    mainSetup(argc, argv);
+
+    int status = runCoarseFineGhostCacheTest(argc, argv);
+
+    if (status == 0)
+        pout() << "CoarseFineGhostCache test passed." << endl;
+    else
+        pout() << "CoarseFineGhostCache test failed with return code "
+               << status << endl;
+
+    mainFinalize();
+    return status;
+}
@@ -0,0 +1,135 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to LICENSE, in Chombo's root directory.
+ */
+#endif
+
+// Chombo includes
+#include "parstream.H" //Gives us pout()
+
+// General includes:
+#include <future>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using std::endl;
+#include "GRAMR.hpp"
+
+#include "AMRReductions.hpp"
+#include "AsyncTaskQueue.hpp"
+#include "DiagnosticsSnapshot.hpp"
+#include "GRParmParse.hpp"
+#include "SetupFunctions.hpp"
+#include "SimulationParameters.hpp"
+
+// Problem specific includes:
+#include "DefaultLevelFactory.hpp"
+#include "DiagnosticsSnapshotTestLevel.hpp"
+#include "GradientSquared.hpp"
+#include "UserVariables.hpp"
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+int runDiagnosticsSnapshotTest(int argc, char *argv[])
+{
+    // Load the parameter file and construct the SimulationParameter class
+    // To add more parameters edit the SimulationParameters file.
+    std::string in_string = argv[argc - 1];
+    pout() << in_string << std::endl;
+    char const *in_file = argv[argc - 1];
+    GRParmParse pp(0, argv + argc, NULL, in_file);
+    SimulationParameters sim_params(pp);
+
+    GRAMR gr_amr;
+    DefaultLevelFactory<DiagnosticsSnapshotTestLevel>
+        diagnostics_snapshot_test_fact(gr_amr, sim_params);
+    setupAMRObject(gr_amr, diagnostics_snapshot_test_fact);
+
+    const std::vector<GRAMRLevel *> levels = gr_amr.get_gramrlevels();
+    const int finest_level = gr_amr.get_finest_level();
+    if (finest_level < 2)
+    {
+        pout() << "expected at least 3 levels but there are "
+               << finest_level + 1 << endl;
+        return 1;
+    }
+
+    // the norm computed on the hierarchy itself
+    gr_amr.fill_multilevel_ghosts(VariableType::evolution);
+    for (GRAMRLevel *level : levels)
+        static_cast<DiagnosticsSnapshotTestLevel *>(level)
+            ->computeDiagnostics();
+    AMRReductions<VariableType::diagnostic> amr_reductions(gr_amr);
+    const double norm = amr_reductions.norm(c_D);
+
+    // the same computed in the background on a snapshot, taken finest level
+    // first as BinaryBHLevel does, while the state is changed
+    DiagnosticsSnapshot snapshot;
+    for (int ilevel = finest_level; ilevel >= 0; --ilevel)
+    {
+        snapshot.add_level(ilevel, levels[ilevel]->getLevelData(),
+                           levels[ilevel]->get_dx(),
+                           levels[ilevel]->refRatio(), NUM_DIAGNOSTIC_VARS);
+    }
+
+    int status = 0;
+    if (!snapshot.has_levels(finest_level) ||
+        snapshot.has_levels(finest_level - 1))
+    {
+        pout() << "has_levels is wrong" << endl;
+        status |= 2;
+    }
+
+    AsyncTaskQueue queue(true);
+    auto computed = std::make_shared<std::promise<void>>();
+    std::shared_future<void> done = computed->get_future();
+    queue.push([boxes = &snapshot.boxes(), computed]() {
+        for (const DiagnosticsSnapshot::box_t &box : *boxes)
+        {
+            BoxLoops::loop(GradientSquared(box.dx), *box.state,
+                           *box.diagnostics, box.valid_box);
+        }
+        computed->set_value();
+    });
+    for (GRAMRLevel *level : levels)
+        static_cast<DiagnosticsSnapshotTestLevel *>(level)->overwriteState();
+    done.wait();
+    const double snapshot_norm = snapshot.norm(Interval(c_D, c_D));
+
+    // the same cells are summed in the same order so the norms are equal
+    if (snapshot_norm != norm || norm == 0.)
+    {
+        pout() << "snapshot norm " << snapshot_norm << " != norm " << norm
+               << endl;
+        status |= 4;
+    }
+
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    mainSetup(argc, argv);
+
+    int status = runDiagnosticsSnapshotTest(argc, argv);
+
+    if (status == 0)
+        pout() << "DiagnosticsSnapshot test passed." << endl;
+    else
+        pout() << "DiagnosticsSnapshot test failed with return code "
+               << status << endl;
+
+    mainFinalize();
+    return status;
+}
@@ -0,0 +1,78 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef DIAGNOSTICSSNAPSHOTTESTLEVEL_HPP_
+#define DIAGNOSTICSSNAPSHOTTESTLEVEL_HPP_
+
+#include "BoxIterator.H"
+#include "BoxLoops.hpp"
+#include "GRAMRLevel.hpp"
+#include "GradientSquared.hpp"
+#include "UserVariables.hpp"
+#include <cmath>
+
+class DiagnosticsSnapshotTestLevel : public GRAMRLevel
+{
+    friend class DefaultLevelFactory<DiagnosticsSnapshotTestLevel>;
+    // Inherit the contructors from GRAMRLevel
+    using GRAMRLevel::GRAMRLevel;
+
+  public:
+    //! Computes D from the state on this level (with its ghosts filled)
+    void computeDiagnostics()
+    {
+        BoxLoops::loop(GradientSquared(m_dx), m_state_new, m_state_diagnostics,
+                       EXCLUDE_GHOST_CELLS);
+    }
+
+    //! Changes the state (e.g. as the evolution would)
+    void overwriteState() { m_state_new.setVal(1.); }
+
+  private:
+    // A is a periodic wave
+    virtual void initialData()
+    {
+        const double k = 2. * M_PI / m_p.L;
+        DataIterator dit = m_state_new.dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+        {
+            FArrayBox &state = m_state_new[dit];
+            for (BoxIterator bit(state.box()); bit.ok(); ++bit)
+            {
+                double A = 1.;
+                for (int dir = 0; dir < SpaceDim; ++dir)
+                    A *= std::sin(k * (bit()[dir] + 0.5) * m_dx);
+                state(bit(), c_A) = A;
+                state(bit(), c_B) = 0.;
+            }
+        }
+    }
+
+    // nothing is evolved
+    virtual void specificEvalRHS(GRLevelData &a_soln, GRLevelData &a_rhs,
+                                 const double a_time)
+    {
+        a_rhs.setVal(0.);
+    }
+
+    // refine a sphere around the center
+    virtual void computeTaggingCriterion(FArrayBox &tagging_criterion,
+                                         const FArrayBox &current_state)
+    {
+        for (BoxIterator bit(tagging_criterion.box()); bit.ok(); ++bit)
+        {
+            double r2 = 0.;
+            for (int dir = 0; dir < SpaceDim; ++dir)
+            {
+                const double x = (bit()[dir] + 0.5) * m_dx - m_p.center[dir];
+                r2 += x * x;
+            }
+            tagging_criterion(bit(), 0) =
+                (r2 < m_p.refinement_radius * m_p.refinement_radius) ? 1. : 0.;
+        }
+    }
+};
+
+#endif /* DIAGNOSTICSSNAPSHOTTESTLEVEL_HPP_ */
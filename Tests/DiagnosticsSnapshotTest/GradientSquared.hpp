@@ -0,0 +1,35 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef GRADIENTSQUARED_HPP_
+#define GRADIENTSQUARED_HPP_
+
+#include "Cell.hpp"
+#include "FourthOrderDerivatives.hpp"
+#include "Tensor.hpp"
+#include "UserVariables.hpp"
+
+/// Computes D = |grad A|^2, whose stencil needs the ghosts of A
+class GradientSquared
+{
+    const FourthOrderDerivatives m_deriv;
+
+  public:
+    GradientSquared(double a_dx) : m_deriv(a_dx) {}
+
+    template <class data_t> void compute(Cell<data_t> current_cell) const
+    {
+        Tensor<1, data_t> d1_A;
+        data_t D = 0.;
+        for (int dir = 0; dir < SpaceDim; ++dir)
+        {
+            m_deriv.diff1(d1_A, current_cell, dir, c_A);
+            D += d1_A[dir] * d1_A[dir];
+        }
+        current_cell.store_vars(D, c_D);
+    }
+};
+
+#endif /* GRADIENTSQUARED_HPP_ */
@@ -0,0 +1,210 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to LICENSE, in Chombo's root directory.
+ */
+#endif
+
+// Chombo includes
+#include "BRMeshRefine.H"
+#include "BoxIterator.H"
+#include "DisjointBoxLayout.H"
+#include "LoadBalance.H"
+#include "parstream.H" //Gives us pout()
+
+// General includes:
+#include <iostream>
+#include <map>
+
+using std::endl;
+#include "GRLevelData.hpp"
+#include "GRParmParse.hpp"
+#include "SetupFunctions.hpp"
+#include "SimulationParameters.hpp"
+#include "UserVariables.hpp"
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+// An exactly representable value which differs in every cell and component
+double cell_value(const IntVect &a_iv, int a_comp, double a_offset)
+{
+    double value = a_offset + a_comp;
+    for (int idir = 0; idir < CH_SPACEDIM; ++idir)
+        value = 100. * value + a_iv[idir];
+    return value;
+}
+
+// Fills all cells (including ghosts) with cell_value
+void fill(GRLevelData &a_data, double a_offset)
+{
+    DataIterator dit = a_data.dataIterator();
+    for (dit.begin(); dit.ok(); ++dit)
+    {
+        FArrayBox &fab = a_data[dit];
+        for (int icomp = 0; icomp < fab.nComp(); ++icomp)
+            for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+                fab(bit(), icomp) = cell_value(bit(), icomp, a_offset);
+    }
+}
+
+// Counts the valid cells (or all cells) which differ from cell_value
+int num_wrong_cells(const GRLevelData &a_data, double a_offset,
+                    bool a_include_ghosts)
+{
+    int num_wrong = 0;
+    DataIterator dit = a_data.dataIterator();
+    for (dit.begin(); dit.ok(); ++dit)
+    {
+        const FArrayBox &fab = a_data[dit];
+        const Box box =
+            a_include_ghosts ? fab.box() : a_data.disjointBoxLayout()[dit];
+        for (int icomp = 0; icomp < fab.nComp(); ++icomp)
+            for (BoxIterator bit(box); bit.ok(); ++bit)
+                if (fab(bit(), icomp) != cell_value(bit(), icomp, a_offset))
+                    ++num_wrong;
+    }
+#ifdef CH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &num_wrong, 1, MPI_INT, MPI_SUM,
+                  Chombo_MPI::comm);
+#endif
+    return num_wrong;
+}
+
+int runGRLevelDataTest(int argc, char *argv[])
+{
+    // Load the parameter file and construct the SimulationParameter class
+    // To add more parameters edit the SimulationParameters file.
+    std::string in_string = argv[argc - 1];
+    pout() << in_string << std::endl;
+    char const *in_file = argv[argc - 1];
+    GRParmParse pp(0, argv + argc, NULL, in_file);
+    SimulationParameters sim_params(pp);
+
+    ProblemDomain domain(Box(IntVect::Zero, sim_params.ivN));
+    for (int idir = 0; idir < CH_SPACEDIM; ++idir)
+        domain.setPeriodic(idir, sim_params.boundary_params.is_periodic[idir]);
+    const IntVect ghosts = sim_params.num_ghosts * IntVect::Unit;
+
+    Vector<Box> old_boxes;
+    Vector<int> old_procs;
+    domainSplit(domain, old_boxes, sim_params.max_grid_size,
+                sim_params.block_factor);
+    LoadBalance(old_procs, old_boxes);
+    DisjointBoxLayout old_grids(old_boxes, old_procs, domain);
+
+    int status = 0;
+
+    // swap exchanges the data without copying it
+    GRLevelData data_a, data_b;
+    data_a.define(old_grids, NUM_VARS, ghosts);
+    data_b.define(old_grids, NUM_VARS, ghosts);
+    fill(data_a, 1.);
+    fill(data_b, 2.);
+    std::map<int, const Real *> ptrs_a;
+    DataIterator dit = old_grids.dataIterator();
+    for (dit.begin(); dit.ok(); ++dit)
+        ptrs_a[dit().datInd()] = data_a[dit].dataPtr();
+    data_a.swap(data_b);
+    for (dit.begin(); dit.ok(); ++dit)
+    {
+        if (data_b[dit].dataPtr() != ptrs_a[dit().datInd()])
+        {
+            pout() << "swap copied the data" << endl;
+            status |= 1;
+        }
+    }
+    if (num_wrong_cells(data_a, 2., true) != 0 ||
+        num_wrong_cells(data_b, 1., true) != 0)
+    {
+        pout() << "swap did not exchange the data" << endl;
+        status |= 2;
+    }
+
+    // Keep every other box (on the same rank) and split the others
+    Vector<Box> new_boxes;
+    Vector<int> new_procs;
+    for (int ibox = 0; ibox < old_boxes.size(); ++ibox)
+    {
+        if (ibox % 2 == 0)
+        {
+            new_boxes.push_back(old_boxes[ibox]);
+            new_procs.push_back(old_procs[ibox]);
+            continue;
+        }
+        Vector<Box> split_boxes;
+        domainSplit(old_boxes[ibox], split_boxes,
+                    sim_params.max_grid_size / 2, sim_params.block_factor / 2);
+        for (int isplit = 0; isplit < split_boxes.size(); ++isplit)
+        {
+            new_boxes.push_back(split_boxes[isplit]);
+            new_procs.push_back((ibox + isplit) % numProc());
+        }
+    }
+    DisjointBoxLayout new_grids(new_boxes, new_procs, domain);
+
+    // the FArrayBoxes of the unchanged boxes are moved (so they keep their
+    // ghosts) and the valid cells of the others are copied
+    std::map<Box, const Real *> unchanged_ptrs;
+    for (dit.begin(); dit.ok(); ++dit)
+        unchanged_ptrs[old_grids[dit]] = data_a[dit].dataPtr();
+    GRLevelData data_new;
+    data_new.defineFrom(data_a, new_grids, FArrayBoxFactory());
+
+    int num_moved = 0;
+    DataIterator new_dit = new_grids.dataIterator();
+    for (new_dit.begin(); new_dit.ok(); ++new_dit)
+    {
+        const Box &box = new_grids[new_dit];
+
+        // unchanged boxes stay on their rank so were local before
+        auto it = unchanged_ptrs.find(box);
+        if (it != unchanged_ptrs.end())
+        {
+            ++num_moved;
+            if (data_new[new_dit].dataPtr() != it->second)
+            {
+                pout() << "the data of " << box << " was not moved" << endl;
+                status |= 4;
+            }
+        }
+    }
+    if (num_wrong_cells(data_new, 2., false) != 0)
+    {
+        pout() << "defineFrom did not reproduce the valid cells" << endl;
+        status |= 8;
+    }
+    pout() << "defineFrom moved " << num_moved << " boxes" << endl;
+
+    // the source is left without data and can be redefined
+    data_a.define(new_grids, NUM_VARS, ghosts);
+    fill(data_a, 3.);
+    if (num_wrong_cells(data_a, 3., true) != 0)
+        status |= 16;
+
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    mainSetup(argc, argv);
+
+    int status = runGRLevelDataTest(argc, argv);
+
+    if (status == 0)
+        pout() << "GRLevelData test passed." << endl;
+    else
+        pout() << "GRLevelData test failed with return code " << status
+               << endl;
+
+    mainFinalize();
+    return status;
+}
@@ -0,0 +1,145 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to LICENSE, in Chombo's root directory.
+ */
+#endif
+
+// Chombo includes
+#include "parstream.H" //Gives us pout()
+
+// General includes:
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using std::endl;
+#include "GRAMR.hpp"
+
+#include "GRParmParse.hpp"
+#include "SetupFunctions.hpp"
+#include "SimulationParameters.hpp"
+
+// Problem specific includes:
+#include "DefaultLevelFactory.hpp"
+#include "MemoryCheckpointTestLevel.hpp"
+#include "UserVariables.hpp"
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+int runMemoryCheckpointTest(int argc, char *argv[])
+{
+    // Load the parameter file and construct the SimulationParameter class
+    // To add more parameters edit the SimulationParameters file.
+    std::string in_string = argv[argc - 1];
+    pout() << in_string << std::endl;
+    char const *in_file = argv[argc - 1];
+    GRParmParse pp(0, argv + argc, NULL, in_file);
+    SimulationParameters sim_params(pp);
+
+    GRAMR gr_amr;
+    DefaultLevelFactory<MemoryCheckpointTestLevel> memory_checkpoint_test_fact(
+        gr_amr, sim_params);
+    setupAMRObject(gr_amr, memory_checkpoint_test_fact);
+
+    std::vector<MemoryCheckpointTestLevel *> levels;
+    for (GRAMRLevel *level : gr_amr.get_gramrlevels())
+        levels.push_back(static_cast<MemoryCheckpointTestLevel *>(level));
+    const int finest_level = gr_amr.get_finest_level();
+
+    int status = 0;
+    if (finest_level < 2)
+    {
+        pout() << "expected at least 3 levels but there are "
+               << finest_level + 1 << endl;
+        return 1;
+    }
+
+    gr_amr.write_memory_checkpoint();
+
+    // some rank specific extra data which must also be recovered from the
+    // buddy (this repeats the exchange of the level data too)
+    const double extra_value = 0.5 + procID();
+    gr_amr.m_memory_checkpoint.extra_data.assign(3, extra_value);
+    gr_amr.m_memory_checkpoint.exchange_with_buddy();
+
+    // Lose this rank's copy of the checkpoint and the state of every level
+    // and change the grids of level 1 but not those of level 2 (so that
+    // level 2 must redefine its coarse-fine operators on restoring)
+    for (MemoryCheckpoint::level_t &level : gr_amr.m_memory_checkpoint.levels)
+        std::fill(level.data.begin(), level.data.end(), std::nan(""));
+    gr_amr.m_memory_checkpoint.extra_data.clear();
+    const int num_level_1_boxes = levels[1]->numBoxes();
+    levels[1]->splitBoxes(sim_params.block_factor);
+    if (levels[1]->numBoxes() == num_level_1_boxes)
+    {
+        pout() << "splitting the boxes of level 1 did not change them" << endl;
+        status |= 2;
+    }
+    for (int ilevel = 0; ilevel <= finest_level; ++ilevel)
+        levels[ilevel]->loseData();
+
+    // recover from the copy on the buddy rank
+    gr_amr.read_memory_checkpoint(true);
+
+    if (gr_amr.m_memory_checkpoint.extra_data !=
+        std::vector<double>(3, extra_value))
+    {
+        pout() << "the extra data was not recovered from the buddy" << endl;
+        status |= 32;
+    }
+
+    if (levels[1]->numBoxes() != num_level_1_boxes)
+    {
+        pout() << "level 1 was not restored to its original grids" << endl;
+        status |= 4;
+    }
+    for (int ilevel = 0; ilevel <= finest_level; ++ilevel)
+    {
+        double max_error = levels[ilevel]->maxError();
+#ifdef CH_MPI
+        MPI_Allreduce(MPI_IN_PLACE, &max_error, 1, MPI_DOUBLE, MPI_MAX,
+                      Chombo_MPI::comm);
+#endif
+        pout() << "level " << ilevel << ": max error = " << max_error << endl;
+        // the restored data is an exact copy
+        if (max_error != 0.)
+            status |= 8;
+        if (!levels[ilevel]->coarseFineOperatorsCurrent())
+        {
+            pout() << "level " << ilevel
+                   << ": the coarse-fine operators are out of date" << endl;
+            status |= 16;
+        }
+    }
+
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    mainSetup(argc, argv);
+
+    int status = runMemoryCheckpointTest(argc, argv);
+
+    if (status == 0)
+        pout() << "MemoryCheckpoint test passed." << endl;
+    else
+        pout() << "MemoryCheckpoint test failed with return code " << status
+               << endl;
+
+    mainFinalize();
+    return status;
+}
@@ -0,0 +1,122 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef MEMORYCHECKPOINTTESTLEVEL_HPP_
+#define MEMORYCHECKPOINTTESTLEVEL_HPP_
+
+#include "BoxIterator.H"
+#include "GRAMRLevel.hpp"
+#include "UserVariables.hpp"
+#include <cmath>
+#include <limits>
+
+class MemoryCheckpointTestLevel : public GRAMRLevel
+{
+    friend class DefaultLevelFactory<MemoryCheckpointTestLevel>;
+    // Inherit the contructors from GRAMRLevel
+    using GRAMRLevel::GRAMRLevel;
+
+    // the data depends on the position and the component
+    double value(const IntVect &a_iv, int a_comp) const
+    {
+        return 42. + a_comp + m_dx * (a_iv[0] + 2. * a_iv[1] + 3. * a_iv[2]);
+    }
+
+    // initialize data
+    virtual void initialData()
+    {
+        DataIterator dit = m_state_new.dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+        {
+            FArrayBox &state = m_state_new[dit];
+            for (BoxIterator bit(state.box()); bit.ok(); ++bit)
+            {
+                for (int comp = 0; comp < NUM_VARS; ++comp)
+                    state(bit(), comp) = value(bit(), comp);
+            }
+        }
+    }
+
+    virtual void specificEvalRHS(GRLevelData &a_soln, GRLevelData &a_rhs,
+                                 const double a_time)
+    {
+    }
+
+    // refine a sphere around the center
+    virtual void computeTaggingCriterion(FArrayBox &tagging_criterion,
+                                         const FArrayBox &current_state)
+    {
+        for (BoxIterator bit(tagging_criterion.box()); bit.ok(); ++bit)
+        {
+            double r2 = 0.;
+            for (int dir = 0; dir < SpaceDim; ++dir)
+            {
+                const double x = (bit()[dir] + 0.5) * m_dx - m_p.center[dir];
+                r2 += x * x;
+            }
+            tagging_criterion(bit(), 0) =
+                (r2 < m_p.refinement_radius * m_p.refinement_radius) ? 1. : 0.;
+        }
+    }
+
+  public:
+    // overwrite the state as if it had been lost
+    void loseData() { m_state_new.setVal(std::nan("")); }
+
+    // regrid onto the current grids split into boxes of at most a_max_size
+    void splitBoxes(int a_max_size)
+    {
+        Vector<Box> split_grids;
+        for (int ibox = 0; ibox < m_level_grids.size(); ++ibox)
+        {
+            Vector<Box> split_boxes;
+            domainSplit(m_level_grids[ibox], split_boxes, a_max_size,
+                        m_p.block_factor);
+            split_grids.append(split_boxes);
+        }
+        // (GRAMRLevel::regrid is private)
+        static_cast<AMRLevel *>(this)->regrid(split_grids);
+    }
+
+    int numBoxes() const { return m_level_grids.size(); }
+
+    // the largest difference of the valid cells (on this rank) from the
+    // initial data
+    double maxError() const
+    {
+        double max_error = 0.;
+        DataIterator dit = m_state_new.dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+        {
+            const FArrayBox &state = m_state_new[dit];
+            for (BoxIterator bit(m_grids[dit]); bit.ok(); ++bit)
+            {
+                for (int comp = 0; comp < NUM_VARS; ++comp)
+                {
+                    const double error =
+                        std::abs(state(bit(), comp) - value(bit(), comp));
+                    // a nan is as bad as it gets
+                    max_error = std::isnan(error)
+                                    ? std::numeric_limits<double>::max()
+                                    : std::max(max_error, error);
+                }
+            }
+        }
+        return max_error;
+    }
+
+    // whether the coarse-fine operators were defined on the current coarser
+    // grids
+    bool coarseFineOperatorsCurrent() const
+    {
+        if (m_coarser_level_ptr == nullptr)
+            return true;
+        const auto *coarser_level_ptr =
+            static_cast<const MemoryCheckpointTestLevel *>(m_coarser_level_ptr);
+        return m_operators_coarser_grids == coarser_level_ptr->m_grids;
+    }
+};
+
+#endif /* MEMORYCHECKPOINTTESTLEVEL_HPP_ */
@@ -0,0 +1,29 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef USERVARIABLES_HPP
+#define USERVARIABLES_HPP
+
+#include "EmptyDiagnosticVariables.hpp"
+#include <array>
+#include <string>
+
+// assign enum to each variable
+enum
+{
+    c_A,
+    c_B,
+
+    NUM_VARS
+};
+
+namespace UserVariables
+{
+static const std::array<std::string, NUM_VARS> variable_names = {"A", "B"};
+}
+
+#include "UserVariables.inc.hpp"
+
+#endif /* USERVARIABLES_HPP */
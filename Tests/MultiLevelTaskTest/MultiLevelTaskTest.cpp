@@ -0,0 +1,139 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to LICENSE, in Chombo's root directory.
+ */
+#endif
+
+// Chombo includes
+#include "parstream.H" //Gives us pout()
+
+// General includes:
+#include <iostream>
+#include <vector>
+
+using std::endl;
+#include "GRAMR.hpp"
+
+#include "GRParmParse.hpp"
+#include "MultiLevelTask.hpp"
+#include "SetupFunctions.hpp"
+#include "SimulationParameters.hpp"
+
+// Problem specific includes:
+#include "DefaultLevelFactory.hpp"
+#include "MultiLevelTaskTestLevel.hpp"
+#include "UserVariables.hpp"
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+int runMultiLevelTaskTest(int argc, char *argv[])
+{
+    // Load the parameter file and construct the SimulationParameter class
+    // To add more parameters edit the SimulationParameters file.
+    std::string in_string = argv[argc - 1];
+    pout() << in_string << std::endl;
+    char const *in_file = argv[argc - 1];
+    GRParmParse pp(0, argv + argc, NULL, in_file);
+    SimulationParameters sim_params(pp);
+
+    GRAMR gr_amr;
+    DefaultLevelFactory<MultiLevelTaskTestLevel> multi_level_task_test_fact(
+        gr_amr, sim_params);
+    setupAMRObject(gr_amr, multi_level_task_test_fact);
+
+    const std::vector<GRAMRLevel *> levels = gr_amr.get_gramrlevels();
+    const int finest_level = gr_amr.get_finest_level();
+
+    int status = 0;
+    if (finest_level < 2)
+    {
+        pout() << "expected at least 3 levels but there are "
+               << finest_level + 1 << endl;
+        return 1;
+    }
+
+    // the number of times the box task visits each local box of each level
+    std::vector<std::vector<int>> num_visits(levels.size());
+    for (int ilevel = 0; ilevel < levels.size(); ++ilevel)
+    {
+        int num_boxes = 0;
+        DataIterator dit = levels[ilevel]->getLevelData().dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+            ++num_boxes;
+        num_visits[ilevel].assign(num_boxes, 0);
+    }
+
+    MultiLevelTaskPtr<> box_task(
+        [&num_visits](GRAMRLevel *a_level, const DataIndex &a_index) {
+            int &visits = num_visits[a_level->level()][a_index.datInd()];
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+            ++visits;
+        });
+    box_task.execute(gr_amr);
+
+    for (int ilevel = 0; ilevel < levels.size(); ++ilevel)
+    {
+        int num_wrong = 0;
+        for (int visits : num_visits[ilevel])
+        {
+            if (visits != 1)
+                ++num_wrong;
+        }
+#ifdef CH_MPI
+        MPI_Allreduce(MPI_IN_PLACE, &num_wrong, 1, MPI_INT, MPI_SUM,
+                      Chombo_MPI::comm);
+#endif
+        if (num_wrong > 0)
+        {
+            pout() << "level " << ilevel << ": " << num_wrong
+                   << " boxes were not visited exactly once" << endl;
+            status |= 2;
+        }
+    }
+
+    // the level task visits each level once, finest first by default
+    std::vector<int> level_order;
+    MultiLevelTaskPtr<> level_task([&level_order](GRAMRLevel *a_level) {
+        level_order.push_back(a_level->level());
+    });
+    level_task.execute(gr_amr);
+    bool reversed = (level_order.size() == levels.size());
+    for (int i = 0; i < level_order.size() && reversed; ++i)
+        reversed = (level_order[i] == static_cast<int>(levels.size()) - 1 - i);
+    if (!reversed)
+    {
+        pout() << "the level task did not visit the levels finest first"
+               << endl;
+        status |= 4;
+    }
+
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    mainSetup(argc, argv);
+
+    int status = runMultiLevelTaskTest(argc, argv);
+
+    if (status == 0)
+        pout() << "MultiLevelTask test passed." << endl;
+    else
+        pout() << "MultiLevelTask test failed with return code " << status
+               << endl;
+
+    mainFinalize();
+    return status;
+}
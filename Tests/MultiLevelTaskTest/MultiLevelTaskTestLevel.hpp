@@ -0,0 +1,46 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef MULTILEVELTASKTESTLEVEL_HPP_
+#define MULTILEVELTASKTESTLEVEL_HPP_
+
+#include "BoxIterator.H"
+#include "GRAMRLevel.hpp"
+#include "UserVariables.hpp"
+
+class MultiLevelTaskTestLevel : public GRAMRLevel
+{
+    friend class DefaultLevelFactory<MultiLevelTaskTestLevel>;
+    // Inherit the contructors from GRAMRLevel
+    using GRAMRLevel::GRAMRLevel;
+
+    virtual void initialData() { m_state_new.setVal(0.); }
+
+    // nothing is evolved
+    virtual void specificEvalRHS(GRLevelData &a_soln, GRLevelData &a_rhs,
+                                 const double a_time)
+    {
+        a_rhs.setVal(0.);
+    }
+
+    // refine a sphere around the center
+    virtual void computeTaggingCriterion(FArrayBox &tagging_criterion,
+                                         const FArrayBox &current_state)
+    {
+        for (BoxIterator bit(tagging_criterion.box()); bit.ok(); ++bit)
+        {
+            double r2 = 0.;
+            for (int dir = 0; dir < SpaceDim; ++dir)
+            {
+                const double x = (bit()[dir] + 0.5) * m_dx - m_p.center[dir];
+                r2 += x * x;
+            }
+            tagging_criterion(bit(), 0) =
+                (r2 < m_p.refinement_radius * m_p.refinement_radius) ? 1. : 0.;
+        }
+    }
+};
+
+#endif /* MULTILEVELTASKTESTLEVEL_HPP_ */
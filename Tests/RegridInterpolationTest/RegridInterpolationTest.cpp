@@ -0,0 +1,148 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to LICENSE, in Chombo's root directory.
+ */
+#endif
+
+// Chombo includes
+#include "parstream.H" //Gives us pout()
+
+// General includes:
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using std::endl;
+#include "GRAMR.hpp"
+
+#include "GRParmParse.hpp"
+#include "SetupFunctions.hpp"
+#include "SimulationParameters.hpp"
+
+// Problem specific includes:
+#include "DefaultLevelFactory.hpp"
+#include "RegridInterpolationTestLevel.hpp"
+#include "UserVariables.hpp"
+
+// Chombo namespace
+#include "UsingNamespace.H"
+
+int runRegridInterpolationTest(int argc, char *argv[])
+{
+    // Load the parameter file and construct the SimulationParameter class
+    // To add more parameters edit the SimulationParameters file.
+    std::string in_string = argv[argc - 1];
+    pout() << in_string << std::endl;
+    char const *in_file = argv[argc - 1];
+    GRParmParse pp(0, argv + argc, NULL, in_file);
+    SimulationParameters sim_params(pp);
+
+    GRAMR gr_amr;
+    DefaultLevelFactory<RegridInterpolationTestLevel>
+        regrid_interpolation_test_fact(gr_amr, sim_params);
+    setupAMRObject(gr_amr, regrid_interpolation_test_fact);
+
+    std::vector<RegridInterpolationTestLevel *> levels;
+    for (GRAMRLevel *level : gr_amr.get_gramrlevels())
+        levels.push_back(static_cast<RegridInterpolationTestLevel *>(level));
+    const int finest_level = gr_amr.get_finest_level();
+
+    if (finest_level < 2)
+    {
+        pout() << "expected at least 3 levels but there are "
+               << finest_level + 1 << endl;
+        return 1;
+    }
+    const Vector<Box> initial_level_1_grids = levels[1]->boxes();
+    auto level_1_grids_changed = [&]() {
+        const Vector<Box> &grids = levels[1]->boxes();
+        if (grids.size() != initial_level_1_grids.size())
+            return true;
+        for (int ibox = 0; ibox < grids.size(); ++ibox)
+        {
+            if (grids[ibox] != initial_level_1_grids[ibox])
+                return true;
+        }
+        return false;
+    };
+
+    // evolve (and regrid) from the same initial data interpolating only the
+    // newly refined regions and interpolating the whole of each level
+    gr_amr.write_memory_checkpoint();
+    std::vector<std::vector<double>> uncovered_only_data(finest_level + 1);
+    for (int ilevel = 0; ilevel <= finest_level; ++ilevel)
+        levels[ilevel]->setMaxUncoveredFraction(1.);
+    gr_amr.run(sim_params.stop_time, sim_params.max_steps);
+    for (int ilevel = 0; ilevel <= finest_level; ++ilevel)
+        uncovered_only_data[ilevel] = levels[ilevel]->validData();
+
+    int status = 0;
+    if (!level_1_grids_changed())
+    {
+        pout() << "the grids of level 1 did not change" << endl;
+        status |= 2;
+    }
+
+    gr_amr.read_memory_checkpoint();
+    for (int ilevel = 0; ilevel <= finest_level; ++ilevel)
+        levels[ilevel]->setMaxUncoveredFraction(0.);
+    gr_amr.run(sim_params.stop_time, sim_params.max_steps);
+
+    for (int ilevel = 0; ilevel <= finest_level; ++ilevel)
+    {
+        const std::vector<double> whole_level_data =
+            levels[ilevel]->validData();
+        double max_diff = 0.;
+        if (whole_level_data.size() != uncovered_only_data[ilevel].size())
+            max_diff = std::numeric_limits<double>::max();
+        for (int i = 0; i < whole_level_data.size() && max_diff == 0.; ++i)
+        {
+            const double diff =
+                std::abs(whole_level_data[i] - uncovered_only_data[ilevel][i]);
+            // a nan is as bad as it gets
+            max_diff = std::isnan(diff) ? std::numeric_limits<double>::max()
+                                        : std::max(max_diff, diff);
+        }
+#ifdef CH_MPI
+        MPI_Allreduce(MPI_IN_PLACE, &max_diff, 1, MPI_DOUBLE, MPI_MAX,
+                      Chombo_MPI::comm);
+#endif
+        pout() << "level " << ilevel
+               << ": max difference interpolating only the newly refined "
+                  "regions = "
+               << max_diff << endl;
+        // each fine cell is interpolated from the coarse data alone
+        if (max_diff != 0.)
+            status |= 4;
+    }
+
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    mainSetup(argc, argv);
+
+    int status = runRegridInterpolationTest(argc, argv);
+
+    if (status == 0)
+        pout() << "RegridInterpolation test passed." << endl;
+    else
+        pout() << "RegridInterpolation test failed with return code "
+               << status << endl;
+
+    mainFinalize();
+    return status;
+}
@@ -0,0 +1,112 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef REGRIDINTERPOLATIONTESTLEVEL_HPP_
+#define REGRIDINTERPOLATIONTESTLEVEL_HPP_
+
+#include "BoxIterator.H"
+#include "GRAMRLevel.hpp"
+#include "UserVariables.hpp"
+#include <array>
+#include <cmath>
+#include <vector>
+
+class RegridInterpolationTestLevel : public GRAMRLevel
+{
+    friend class DefaultLevelFactory<RegridInterpolationTestLevel>;
+    // Inherit the contructors from GRAMRLevel
+    using GRAMRLevel::GRAMRLevel;
+
+    // A is a periodic wave, initially at rest
+    virtual void initialData()
+    {
+        const double k = 2. * M_PI / m_p.L;
+        DataIterator dit = m_state_new.dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+        {
+            FArrayBox &state = m_state_new[dit];
+            for (BoxIterator bit(state.box()); bit.ok(); ++bit)
+            {
+                double A = 1.;
+                for (int dir = 0; dir < SpaceDim; ++dir)
+                    A *= std::sin(k * (bit()[dir] + 0.5) * m_dx);
+                state(bit(), c_A) = A;
+                state(bit(), c_B) = 0.;
+            }
+        }
+    }
+
+    // the wave equation dA/dt = B, dB/dt = Laplacian(A)
+    virtual void specificEvalRHS(GRLevelData &a_soln, GRLevelData &a_rhs,
+                                 const double a_time)
+    {
+        const DisjointBoxLayout &grids = a_rhs.disjointBoxLayout();
+        DataIterator dit = a_rhs.dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+        {
+            const FArrayBox &soln = a_soln[dit];
+            FArrayBox &rhs = a_rhs[dit];
+            for (BoxIterator bit(grids[dit]); bit.ok(); ++bit)
+            {
+                const IntVect &iv = bit();
+                double laplacian = 0.;
+                for (int dir = 0; dir < SpaceDim; ++dir)
+                {
+                    const IntVect shift = BASISV(dir);
+                    laplacian += (soln(iv + shift, c_A) - 2. * soln(iv, c_A) +
+                                  soln(iv - shift, c_A)) /
+                                 (m_dx * m_dx);
+                }
+                rhs(iv, c_A) = soln(iv, c_B);
+                rhs(iv, c_B) = laplacian;
+            }
+        }
+    }
+
+    // refine a sphere which starts at the center and moves in x (so that
+    // each regrid keeps some of the old grids and adds new ones)
+    virtual void computeTaggingCriterion(FArrayBox &tagging_criterion,
+                                         const FArrayBox &current_state)
+    {
+        std::array<double, CH_SPACEDIM> sphere_center = m_p.center;
+        sphere_center[0] += m_p.refinement_speed * m_time;
+        for (BoxIterator bit(tagging_criterion.box()); bit.ok(); ++bit)
+        {
+            double r2 = 0.;
+            for (int dir = 0; dir < SpaceDim; ++dir)
+            {
+                const double x = (bit()[dir] + 0.5) * m_dx - sphere_center[dir];
+                r2 += x * x;
+            }
+            tagging_criterion(bit(), 0) =
+                (r2 < m_p.refinement_radius * m_p.refinement_radius) ? 1. : 0.;
+        }
+    }
+
+  public:
+    void setMaxUncoveredFraction(double a_fraction)
+    {
+        m_p.regrid_max_uncovered_fraction = a_fraction;
+    }
+
+    // the valid cells of the local boxes (in DataIterator order)
+    std::vector<double> validData() const
+    {
+        std::vector<double> data;
+        DataIterator dit = m_state_new.dataIterator();
+        for (dit.begin(); dit.ok(); ++dit)
+        {
+            const FArrayBox &state = m_state_new[dit];
+            for (BoxIterator bit(m_grids[dit]); bit.ok(); ++bit)
+            {
+                for (int comp = 0; comp < NUM_VARS; ++comp)
+                    data.push_back(state(bit(), comp));
+            }
+        }
+        return data;
+    }
+};
+
+#endif /* REGRIDINTERPOLATIONTESTLEVEL_HPP_ */
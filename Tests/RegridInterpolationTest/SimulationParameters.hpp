@@ -0,0 +1,26 @@
+/* GRChombo
+ * Copyright 2012 The GRChombo collaboration.
+ * Please refer to LICENSE in GRChombo's root directory.
+ */
+
+#ifndef SIMULATIONPARAMETERS_HPP_
+#define SIMULATIONPARAMETERS_HPP_
+
+// General includes
+#include "ChomboParameters.hpp"
+#include "GRParmParse.hpp"
+
+class SimulationParameters : public ChomboParameters
+{
+  public:
+    SimulationParameters(GRParmParse &pp) : ChomboParameters(pp)
+    {
+        pp.load("refinement_radius", refinement_radius, L / 6);
+        pp.load("refinement_speed", refinement_speed, 0.);
+    }
+
+    double refinement_radius; // the radius of the refined region
+    double refinement_speed;  // the speed it moves at in the x direction
+};
+
+#endif /* SIMULATIONPARAMETERS_HPP_ */
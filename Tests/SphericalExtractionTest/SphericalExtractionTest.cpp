@@ -37,6 +37,7 @@ using std::endl;
 #include "Lagrange.hpp"
 #include "SphericalExtraction.hpp"
 #include "SphericalExtractionTestLevel.hpp"
+#include "SurfaceDenseOutput.hpp"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -45,6 +46,101 @@ using std::endl;
 // Chombo namespace
 #include "UsingNamespace.H"
 
+// Checks the output times and values of a SurfaceDenseOutput of the extracted
+// data a_data scaled linearly in time (which it interpolates exactly) and
+// that it restarts correctly from its state and from a seed
+int testSurfaceDenseOutput(const SurfaceDenseOutput::data_t &a_data)
+{
+    auto data_at = [&a_data](double a_time) {
+        SurfaceDenseOutput::data_t data = a_data;
+        for (auto &var_data : data)
+        {
+            for (double &value : var_data)
+                value *= 1. + 2. * a_time;
+        }
+        return data;
+    };
+    auto max_error = [&data_at](const SurfaceDenseOutput &a_output,
+                                double a_time) {
+        const SurfaceDenseOutput::data_t expected = data_at(a_time);
+        const SurfaceDenseOutput::data_t interpolated =
+            a_output.interpolate(a_time);
+        double error = 0.;
+        for (int ivar = 0; ivar < expected.size(); ++ivar)
+        {
+            for (int ipoint = 0; ipoint < expected[ivar].size(); ++ipoint)
+            {
+                error = std::max(error,
+                                 std::abs(interpolated[ivar][ipoint] -
+                                          expected[ivar][ipoint]));
+            }
+        }
+        return error;
+    };
+
+    int status = 0;
+    const double output_dt = 0.25;
+    const std::vector<double> sample_times = {0., 0.3, 0.7, 1.2};
+    const std::vector<double> expected_times = {0., 0.25, 0.5, 0.75, 1.};
+    SurfaceDenseOutput dense_output(output_dt);
+    SurfaceDenseOutput restored_output(output_dt);
+    std::vector<double> output_times;
+    for (int isample = 0; isample < sample_times.size(); ++isample)
+    {
+        const double time = sample_times[isample];
+        const std::vector<double> times =
+            dense_output.add_sample(time, data_at(time));
+        for (double output_time : times)
+        {
+            output_times.push_back(output_time);
+            if (max_error(dense_output, output_time) > 1e-10)
+                status |= 2;
+        }
+
+        // a copy restored from the state must give the same output
+        if (isample == 1)
+            restored_output.set_state(dense_output.get_state().begin());
+        if (isample > 1)
+        {
+            const std::vector<double> restored_times =
+                restored_output.add_sample(time, data_at(time));
+            if (restored_times != times)
+                status |= 4;
+            for (double output_time : times)
+            {
+                if (restored_output.interpolate(output_time) !=
+                    dense_output.interpolate(output_time))
+                    status |= 4;
+            }
+        }
+    }
+    if (output_times.size() != expected_times.size())
+        status |= 8;
+    for (int itime = 0; itime < output_times.size() && !(status & 8); ++itime)
+    {
+        if (std::abs(output_times[itime] - expected_times[itime]) > 1e-12)
+            status |= 8;
+    }
+
+    // after seeding (e.g. on restart) only the later output times are output
+    SurfaceDenseOutput seeded_output(output_dt);
+    seeded_output.seed(0.5, data_at(0.5));
+    const std::vector<double> seeded_times =
+        seeded_output.add_sample(1.2, data_at(1.2));
+    if (seeded_times.size() != 2 || std::abs(seeded_times[0] - 0.75) > 1e-12)
+        status |= 16;
+    for (double output_time : seeded_times)
+    {
+        if (max_error(seeded_output, output_time) > 1e-10)
+            status |= 16;
+    }
+
+    if (status != 0)
+        pout() << "SurfaceDenseOutput test failed with code " << status
+               << endl;
+    return status;
+}
+
 int runSphericalExtractionTest(int argc, char *argv[])
 {
     // Load the parameter file and construct the SimulationParameter class
@@ -187,6 +283,8 @@ int runSphericalExtractionTest(int argc, char *argv[])
                << endl;
     }
 
+    status |= testSurfaceDenseOutput(spherical_extraction_lo.get_interp_data());
+
     return status;
 }
 